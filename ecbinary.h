@@ -0,0 +1,387 @@
+/* ECBinary     Copyright (C) 2026 Frans Faase
+
+   Binary formats for exact cover matrices, as written by pianofrac and
+   read by ExactCover, and for their solutions, as written by ExactCover
+   and read by pianofrac.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+GNU General Public License:
+   http://www.iwriteiam.nl/GNU.txt
+
+Format:
+   All numbers are stored in the byte order of the machine. A file
+   consists of:
+   - the header (see ECBinaryHeader),
+   - for each row the index of its first column (nr_rows+1 uint64_t),
+   - for each row the number of its name (nr_rows uint32_t),
+   - the columns of all rows (nr_entries uint32_t), padded to 8 bytes,
+   - for each name the offset of its first character (nr_names uint64_t),
+   - the names, each terminated with a '\0'.
+   Rows with the same name share one entry in the name table.
+
+   Binary format for the solutions, as written by ExactCover and read by
+   pianofrac. All numbers are stored as variable length integers: seven
+   bits per byte, with the highest bit set for all but the last byte.
+   The stream consists of:
+   - the magic "ECS1",
+   - the number of rows, followed by the name of each row as its length
+     and its characters,
+   - for each solution, the number of rows in it, followed by the numbers
+     of these rows (starting at zero).
+
+*/
+
+#ifndef ECBINARY_H
+#define ECBINARY_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define EC_BINARY_MAGIC "ECB1"
+#define EC_SOLUTIONS_MAGIC "ECS1"
+
+struct ECBinaryHeader
+{
+	char magic[4];
+	uint32_t nr_columns;
+	uint32_t nr_rows;
+	uint32_t nr_names;
+	uint64_t nr_entries;
+	uint64_t names_size;
+};
+
+class ECBinaryWriter
+{
+public:
+	ECBinaryWriter(int nr_columns) : _nr_columns(nr_columns), _names_size(0) { _row_start.push_back(0); }
+
+	void add_row(const bool *vector, const char *name)
+	{
+		for (int i = 0; i < _nr_columns; i++)
+			if (vector[i])
+				_columns.push_back(i);
+		_row_start.push_back(_columns.size());
+
+		std::pair<std::map<std::string, uint32_t>::iterator, bool> ins = _name_nrs.insert(std::make_pair(std::string(name), (uint32_t)_name_start.size()));
+		if (ins.second)
+		{
+			_name_start.push_back(_names_size);
+			_names_size += strlen(name) + 1;
+			_names.push_back(ins.first);
+		}
+		_row_name.push_back(ins.first->second);
+	}
+
+	void write(FILE *f)
+	{
+		ECBinaryHeader header;
+		memcpy(header.magic, EC_BINARY_MAGIC, 4);
+		header.nr_columns = _nr_columns;
+		header.nr_rows = _row_name.size();
+		header.nr_names = _name_start.size();
+		header.nr_entries = _columns.size();
+		header.names_size = _names_size;
+		fwrite(&header, sizeof(header), 1, f);
+		fwrite(&_row_start[0], sizeof(uint64_t), _row_start.size(), f);
+		if (_row_name.size() > 0)
+			fwrite(&_row_name[0], sizeof(uint32_t), _row_name.size(), f);
+		if (_columns.size() > 0)
+			fwrite(&_columns[0], sizeof(uint32_t), _columns.size(), f);
+		uint32_t padding = 0;
+		fwrite(&padding, 1, padding_size(), f);
+		if (_name_start.size() > 0)
+			fwrite(&_name_start[0], sizeof(uint64_t), _name_start.size(), f);
+		for (size_t i = 0; i < _names.size(); i++)
+			fwrite(_names[i]->first.c_str(), 1, _names[i]->first.size() + 1, f);
+	}
+
+private:
+	size_t padding_size() { return ((_row_name.size() + _columns.size()) % 2) * sizeof(uint32_t); }
+	int _nr_columns;
+	std::vector<uint64_t> _row_start;
+	std::vector<uint32_t> _row_name;
+	std::vector<uint32_t> _columns;
+	std::map<std::string, uint32_t> _name_nrs;
+	std::vector<std::map<std::string, uint32_t>::iterator> _names;
+	std::vector<uint64_t> _name_start;
+	uint64_t _names_size;
+};
+
+// The contents of a file in memory. A regular file is mapped in memory,
+// other files (like pipes) are read.
+class ECMappedFile
+{
+public:
+	ECMappedFile() : _data(0), _size(0), _mapped(false) {}
+	~ECMappedFile()
+	{
+		if (_mapped)
+			munmap(_data, _size);
+		else
+			free(_data);
+	}
+
+	// Returns an error message on failure.
+	const char *open(FILE *f)
+	{
+		struct stat st;
+		if (fstat(fileno(f), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+		{
+			_size = st.st_size;
+			_data = (char*)mmap(0, _size, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+			if (_data == MAP_FAILED)
+			{
+				_data = 0;
+				return "cannot map the file in memory";
+			}
+			_mapped = true;
+			madvise(_data, _size, MADV_SEQUENTIAL);
+			return 0;
+		}
+
+		size_t capacity = 1 << 20;
+		_data = (char*)malloc(capacity);
+		for (size_t n; _data != 0 && (n = fread(_data + _size, 1, capacity - _size, f)) > 0;)
+		{
+			_size += n;
+			if (_size == capacity)
+			{
+				capacity *= 2;
+				_data = (char*)realloc(_data, capacity);
+			}
+		}
+		if (_data == 0)
+			return "cannot allocate memory for the file";
+		return 0;
+	}
+
+	const char *data() const { return _data; }
+	size_t size() const { return _size; }
+
+private:
+	char *_data;
+	size_t _size;
+	bool _mapped;
+};
+
+class ECBinaryReader
+{
+public:
+	// Maps the file in memory, or reads it when it is not a regular
+	// file. Returns an error message on failure, also when the file is
+	// not consistent, such that no row, column or name is out of bounds.
+	const char *open(FILE *f)
+	{
+		const char *error = _file.open(f);
+		if (error != 0)
+			return error;
+		const char *data = _file.data();
+		uint64_t size = _file.size();
+
+		if (size < sizeof(ECBinaryHeader) || memcmp(data, EC_BINARY_MAGIC, 4) != 0)
+			return "not a binary exact cover file";
+		_header = (const ECBinaryHeader*)data;
+
+		// The sizes in the header are checked before they are used as
+		// offsets, such that they cannot overflow
+		uint64_t offset = sizeof(ECBinaryHeader);
+		uint64_t row_start_offset = offset;
+		if (!skip(offset, (uint64_t)_header->nr_rows + 1, sizeof(uint64_t), size))
+			return "the binary exact cover file is truncated";
+		uint64_t row_name_offset = offset;
+		if (!skip(offset, _header->nr_rows, sizeof(uint32_t), size))
+			return "the binary exact cover file is truncated";
+		uint64_t columns_offset = offset;
+		if (   !skip(offset, _header->nr_entries, sizeof(uint32_t), size)
+			|| !skip(offset, (_header->nr_rows + _header->nr_entries) % 2, sizeof(uint32_t), size))
+			return "the binary exact cover file is truncated";
+		uint64_t name_start_offset = offset;
+		if (!skip(offset, _header->nr_names, sizeof(uint64_t), size))
+			return "the binary exact cover file is truncated";
+		uint64_t names_offset = offset;
+		if (!skip(offset, _header->names_size, 1, size))
+			return "the binary exact cover file is truncated";
+		_row_start = (const uint64_t*)(data + row_start_offset);
+		_row_name = (const uint32_t*)(data + row_name_offset);
+		_columns = (const uint32_t*)(data + columns_offset);
+		_name_start = (const uint64_t*)(data + name_start_offset);
+		_names = data + names_offset;
+
+		if (_row_start[0] != 0 || _row_start[_header->nr_rows] != _header->nr_entries)
+			return "the binary exact cover file has wrong row offsets";
+		for (uint32_t row = 0; row < _header->nr_rows; row++)
+			if (_row_start[row] > _row_start[row + 1])
+				return "the binary exact cover file has wrong row offsets";
+			else if (_row_name[row] >= _header->nr_names)
+				return "the binary exact cover file has a wrong name number";
+		for (uint64_t i = 0; i < _header->nr_entries; i++)
+			if (_columns[i] >= _header->nr_columns)
+				return "the binary exact cover file has a wrong column";
+		// As the names end with a '\0', every name that starts within
+		// them, is terminated
+		if (_header->nr_names > 0 && (_header->names_size == 0 || _names[_header->names_size - 1] != '\0'))
+			return "the binary exact cover file has a wrong name";
+		for (uint32_t i = 0; i < _header->nr_names; i++)
+			if (_name_start[i] >= _header->names_size)
+				return "the binary exact cover file has a wrong name";
+		return 0;
+	}
+
+	uint32_t nr_columns() const { return _header->nr_columns; }
+	uint32_t nr_rows() const { return _header->nr_rows; }
+	uint64_t nr_entries() const { return _header->nr_entries; }
+	const uint32_t *row_begin(uint32_t row) const { return _columns + _row_start[row]; }
+	const uint32_t *row_end(uint32_t row) const { return _columns + _row_start[row + 1]; }
+	const char *name(uint32_t row) const { return _names + _name_start[_row_name[row]]; }
+
+private:
+	// Moves the offset over count elements of the given size, when they
+	// fit in the file
+	static bool skip(uint64_t &offset, uint64_t count, uint64_t element_size, uint64_t size)
+	{
+		if (count > (size - offset) / element_size)
+			return false;
+		offset += count * element_size;
+		return true;
+	}
+	ECMappedFile _file;
+	const ECBinaryHeader *_header;
+	const uint64_t *_row_start;
+	const uint32_t *_row_name;
+	const uint32_t *_columns;
+	const uint64_t *_name_start;
+	const char *_names;
+};
+
+inline void append_varint(std::string &buffer, uint64_t value)
+{
+	for (; value >= 0x80; value >>= 7)
+		buffer += (char)(value | 0x80);
+	buffer += (char)value;
+}
+
+inline void append_solutions_header(std::string &buffer, uint64_t nr_rows, const char *const *names)
+{
+	buffer += EC_SOLUTIONS_MAGIC;
+	append_varint(buffer, nr_rows);
+	for (uint64_t i = 0; i < nr_rows; i++)
+	{
+		size_t len = strlen(names[i]);
+		append_varint(buffer, len);
+		buffer.append(names[i], len);
+	}
+}
+
+class ECSolutionReader
+{
+public:
+	ECSolutionReader(FILE *f) : _f(f), _error(0) {}
+
+	// Reads the magic and the names. Returns an error message on failure.
+	// The counts in the stream are not trusted: the names and the rows are
+	// only allocated as far as their bytes have been read.
+	const char *open()
+	{
+		char magic[4];
+		if (fread(magic, 1, 4, _f) != 4 || memcmp(magic, EC_SOLUTIONS_MAGIC, 4) != 0)
+			return "not a binary solutions file";
+		uint64_t nr_rows;
+		if (!read_varint(nr_rows))
+			return "the binary solutions file is truncated";
+		for (uint64_t i = 0; i < nr_rows; i++)
+		{
+			uint64_t len;
+			if (!read_varint(len))
+				return "the binary solutions file is truncated";
+			_names.push_back(std::string());
+			char buffer[4096];
+			while (len > 0)
+			{
+				size_t n = len < sizeof(buffer) ? len : sizeof(buffer);
+				if (fread(buffer, 1, n, _f) != n)
+					return "the binary solutions file is truncated";
+				_names.back().append(buffer, n);
+				len -= n;
+			}
+		}
+		return 0;
+	}
+
+	// Reads the next solution. Returns false at the end of the stream, or
+	// when the solution is wrong, in which case error() returns a message.
+	bool next(std::vector<uint32_t> &rows)
+	{
+		rows.clear();
+		uint64_t nr;
+		if (!read_varint(nr))
+			return false;
+		// The rows of an exact cover solution are different
+		if (nr > _names.size())
+		{
+			_error = "the binary solutions file has a wrong number of rows";
+			return false;
+		}
+		for (uint64_t i = 0; i < nr; i++)
+		{
+			uint64_t row;
+			if (!read_varint(row))
+			{
+				_error = "the binary solutions file is truncated";
+				return false;
+			}
+			if (row >= _names.size())
+			{
+				_error = "the binary solutions file has a wrong row";
+				return false;
+			}
+			rows.push_back(row);
+		}
+		return true;
+	}
+
+	const char *error() const { return _error; }
+
+	size_t nr_rows() const { return _names.size(); }
+	const char *name(uint32_t row) const { return _names[row].c_str(); }
+
+private:
+	bool read_varint(uint64_t &value)
+	{
+		value = 0;
+		for (int shift = 0; shift < 64; shift += 7)
+		{
+			int ch = getc(_f);
+			if (ch == EOF)
+				return false;
+			value |= (uint64_t)(ch & 0x7f) << shift;
+			if ((ch & 0x80) == 0)
+				return true;
+		}
+		return false;
+	}
+	FILE *_f;
+	std::vector<std::string> _names;
+	const char *_error;
+};
+
+#endif
@@ -0,0 +1,4357 @@
+/*  ECSolver - the exact cover solver of ExactCover
+
+    This header contains the solver of ExactCover: the dancing links
+    matrix, the reductions, the search with its branching heuristic,
+    propagation, components, memoized counting, threads, checkpoints,
+    shards and the bitset engine. ExactCover.cpp is the program that reads
+    an exact cover from the stdin and writes the solutions, using this
+    header. Other programs, such as pianofrac, can use it to solve exact
+    covers in-process, such that the exact cover and its solutions do not
+    have to be written and parsed.
+
+    The solutions are passed to an ECSolutionVisitor as the numbers of
+    their rows, in the order in which the rows were added (starting at
+    zero). Rows with the same columns are merged, and a solution with a
+    merged row is passed for each of its rows. With threads, the calls of
+    the visitor are serialized.
+
+    The state of the solver is kept in an ECEngine, which has the options
+    of ECOptions as its members. The threads of the search have engines
+    of their own. Nothing is logged, unless flog is set. Each ECSolver has
+    its own engine, such that several solvers can be used at the same time.
+
+    Usage:
+        ECSolver solver(nr_columns);
+        solver.options().opt_threads = 4;  // optional
+        solver.add_row(vector, name);      // for each row
+        solver.solve(visitor);             // or solver.count()
+
+    For more information see: http://www.iwriteiam.nl/Dpuzzle.html#EC
+
+    Copyright (C) 2016 Frans Faase    http://www.iwriteiam.nl/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+    
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+GNU General Public License:
+    http://www.iwriteiam.nl/GNU.txt
+*/
+
+#ifndef ECSOLVER_H
+#define ECSOLVER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <map>
+#include <algorithm>
+#include <stdint.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#include "ecbinary.h"
+
+class ECSolutionVisitor
+{
+public:
+    virtual ~ECSolutionVisitor() {}
+    // Called for each solution. Returning true stops the search.
+    virtual bool solution(const uint32_t *rows, size_t nr_rows) = 0;
+    // For checkpoints: returns the size of the output written so far,
+    // or -1 when it is unknown
+    virtual long output_size() { return -1; }
+    // When resuming: truncates the output to the size of the checkpoint.
+    // Returns false when this is not possible.
+    virtual bool truncate_output(long size) { (void)size; return false; }
+};
+
+// The branching heuristic used by solve() to select a column
+enum Branch
+{
+    BRANCH_MRV, // column with the fewest vectors left
+    BRANCH_MAX  // first column with one vector left, else the column with the most
+};
+
+// The options of the solver (see ExactCover.cpp for their meaning)
+struct ECOptions
+{
+    bool opt_reduce = true;
+    int opt_reduce_tries = 0;
+    bool opt_only_reduce = false;
+    bool opt_reduce_groups = false;
+    int opt_threads = 1;
+    bool opt_bitset = true;
+    bool opt_keep_duplicates = false;
+    int opt_propagate = 0;
+    bool opt_components = false;
+    Branch opt_branch = BRANCH_MRV;
+    bool opt_count = false;
+    long opt_count_table = 1 << 22;
+    long opt_nogood_table = 1 << 16;
+    const char *opt_symmetry = 0;
+    const char *opt_checkpoint = 0;
+    const char *opt_resume = 0;
+    long opt_checkpoint_interval = 60;
+    long opt_estimate = 0;
+    bool opt_only_estimate = false;
+    int opt_shard = 0;
+    int opt_nr_shards = 0;
+    bool opt_profile = false;
+    // The log of the reduction and the search, or 0 for none
+    FILE *flog = 0;
+};
+
+// The names of the vectors are copied into blocks, which are never freed
+
+#define NAME_BLOCK_SIZE (1 << 20)
+
+class NameArena
+{
+public:
+    NameArena() : _free(0), _left(0) {}
+    
+    // Copies the len characters of name, followed by a '\0'
+    char *copy(const char *name, size_t len)
+    {
+        if (len + 1 > _left)
+        {
+            _left = len + 1 > NAME_BLOCK_SIZE ? len + 1 : NAME_BLOCK_SIZE;
+            _free = (char*)malloc(_left);
+            if (_free == 0)
+            {
+                fprintf(stderr, "Fatal error: Cannot allocate %lu bytes for the names\n", (unsigned long)_left);
+                exit(1);
+            }
+        }
+        char *result = _free;
+        memcpy(result, name, len);
+        result[len] = '\0';
+        _free += len + 1;
+        _left -= len + 1;
+        return result;
+    }
+
+private:
+    char *_free;
+    size_t _left;
+};
+
+// The readers collect the vectors, after which the matrix is build
+struct MatrixInput
+{
+    MatrixInput() : nr_positions(0) { vector_start.push_back(0); }
+    int nr_positions;
+    std::vector<int> entries;
+    std::vector<size_t> vector_start;
+    std::vector<char*> names;
+    NameArena name_arena;
+    
+    // Adds a vector with a copy of the len characters of name
+    void add_vector(const char *name, size_t len)
+    {
+        vector_start.push_back(entries.size());
+        names.push_back(name_arena.copy(name, len));
+    }
+    
+    // Adds a vector with a name that stays in memory
+    void add_vector(const char *name)
+    {
+        vector_start.push_back(entries.size());
+        names.push_back((char*)name);
+    }
+    
+    // Appends the vectors of another input
+    void append(MatrixInput &other)
+    {
+        if (other.nr_positions > nr_positions)
+            nr_positions = other.nr_positions;
+        if (names.empty())
+        {
+            entries.swap(other.entries);
+            vector_start.swap(other.vector_start);
+            names.swap(other.names);
+            return;
+        }
+        size_t offset = entries.size();
+        entries.insert(entries.end(), other.entries.begin(), other.entries.end());
+        for (size_t i = 1; i < other.vector_start.size(); i++)
+            vector_start.push_back(offset + other.vector_start[i]);
+        names.insert(names.end(), other.names.begin(), other.names.end());
+        std::vector<int>().swap(other.entries);
+    }
+};
+
+// The state of the solver
+//
+// The reduction and the search work on the matrix of an engine. The
+// threads of the search and of the lookahead of the reduction each have
+// an engine of their own, which is made from the main engine, with a copy
+// of its options, its matrix and the tables for the solutions and the
+// symmetries. The visitor, the tasks and the progress of the search are
+// shared with the main engine.
+
+class ECEngine : public ECOptions
+{
+public:
+    struct Worker;
+    
+    ECEngine() : shared(&_main_shared) {}
+    
+    // The engine of a thread of the search (or the reduction, when worker
+    // is 0)
+    ECEngine(const ECEngine &main, Worker *worker) : ECOptions(main), shared(main.shared)
+    {
+        copy_matrix(main.matrix);
+        nr_pos = main.nr_pos;
+        nr_vec = main.nr_vec;
+        nr_pos_with_zero_vec = main.nr_pos_with_zero_vec;
+        nr_duplicate_vectors = main.nr_duplicate_vectors;
+        vector_rows = main.vector_rows;
+        alias_rows = main.alias_rows;
+        alias_start = main.alias_start;
+        sym_perms = main.sym_perms;
+        sym_column = main.sym_column;
+        sym_pre_column = main.sym_pre_column;
+        sym_image = main.sym_image;
+        sym_vector_start = main.sym_vector_start;
+        sym_entries = main.sym_entries;
+        cur_worker = worker;
+    }
+    
+    ~ECEngine()
+    {
+        free_probe_engines();
+        for (size_t i = 0; i < _main_shared.workers.size(); i++)
+            delete _main_shared.workers[i];
+        free(matrix.block);
+    }
+    
+    // The state that the engines of the search share with the main engine
+    struct Shared
+    {
+        Shared() : solution_visitor(0), search_stopped(false), next_start_task(0), nr_active_workers(0),
+                   estimated_nodes(0.0), search_start_time(0), nr_nodes_before_search(0), nr_nodes_visited(0), next_progress(0) {}
+        
+        // See output_solution()
+        ECSolutionVisitor *solution_visitor;
+        std::mutex solution_visitor_mutex;
+        std::atomic<bool> search_stopped;
+        
+        // See solve_with_threads(). The tasks the search starts with are the
+        // whole search, or the tasks of a shard. Idle workers take these
+        // before stealing.
+        std::vector<Worker*> workers;
+        std::vector<std::vector<int> > start_tasks;
+        std::atomic<size_t> next_start_task;
+        std::atomic<int> nr_active_workers;
+        
+        // See progress()
+        double estimated_nodes;
+        time_t search_start_time;
+        long nr_nodes_before_search;
+        std::atomic<long> nr_nodes_visited;
+        std::atomic<time_t> next_progress;
+    };
+    Shared *shared;
+    
+    // Returns whether the visitor stopped the search
+    bool stopped() const { return shared->search_stopped; }
+    
+    static bool tracePrint()
+    {
+        return false;
+        
+        static clock_t tick = clock() + 5000;
+        if (clock() < tick)
+            return false;
+            
+        tick = clock() + 5000;
+        return true;
+    }
+
+    // Profiling
+    //
+    // With -profile the time spent in the phases of the program (which can be
+    // nested) is measured, and for each depth of the search the number of
+    // nodes, branches, dead ends, solutions, covered and uncovered columns and
+    // the time spent in the nodes (including the nodes below them). When the
+    // search uses threads, their times are added. At the end, the profile is
+    // written to profile.json and, as folded stacks that can be read by flame
+    // graph tools, to profile.folded.
+
+    static double wall_time()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+
+    // The phases are identified by the names of the phases they are nested in
+    // and their own name, separated by ';'. For each phase the total time and
+    // the time that is not spent in nested phases is recorded.
+    std::string phase_stack = "ExactCover";
+    std::map<std::string, double> phase_time;
+    std::map<std::string, double> phase_self_time;
+
+    class PhaseTimer
+    {
+    public:
+        PhaseTimer(ECEngine &engine, const char *name) : _engine(engine), _active(engine.opt_profile)
+        {
+            if (!_active)
+                return;
+            _parent_length = _engine.phase_stack.size();
+            _engine.phase_stack.append(";").append(name);
+            _start = wall_time();
+        }
+        ~PhaseTimer()
+        {
+            if (!_active)
+                return;
+            double elapsed = wall_time() - _start;
+            std::string &phase_stack = _engine.phase_stack;
+            _engine.phase_time[phase_stack] += elapsed;
+            _engine.phase_self_time[phase_stack] += elapsed;
+            phase_stack.resize(_parent_length);
+            _engine.phase_self_time[phase_stack] -= elapsed;
+        }
+
+    private:
+        ECEngine &_engine;
+        bool _active;
+        size_t _parent_length;
+        double _start;
+    };
+
+    struct DepthProfile
+    {
+        DepthProfile() : nodes(0), branches(0), dead_ends(0), propagated(0), solutions(0), covers(0), uncovers(0), seconds(0.0) {}
+        long nodes;
+        long branches;
+        long dead_ends;
+        long propagated;
+        long solutions;
+        long covers;
+        long uncovers;
+        double seconds;
+    };
+
+    std::vector<DepthProfile> depth_profile;
+    long nr_covers = 0;
+    long nr_uncovers = 0;
+
+    inline DepthProfile &depth_stats(int depth)
+    {
+        if ((size_t)depth >= depth_profile.size())
+            depth_profile.resize(depth + 1);
+        return depth_profile[depth];
+    }
+
+    // Records a node of the search and the time spent in it
+    class ProfiledNode
+    {
+    public:
+        ProfiledNode(ECEngine &engine, int depth) : _engine(engine), _depth(depth)
+        {
+            if (!_engine.opt_profile)
+                return;
+            _engine.depth_stats(depth).nodes++;
+            _start = wall_time();
+        }
+        ~ProfiledNode()
+        {
+            if (_engine.opt_profile)
+                _engine.depth_stats(_depth).seconds += wall_time() - _start;
+        }
+
+    private:
+        ECEngine &_engine;
+        int _depth;
+        double _start;
+    };
+
+    // The matrix is stored as a struct of arrays in one allocation. All
+    // nodes (the root, the column headers, the vector headers and the
+    // 1-entries) are identified by a 32 bits index. For each node there are
+    // the four links and the vector and position (column) it belongs to.
+    // The header nodes of the positions come directly after the root and
+    // are followed by the header nodes of the vectors.
+
+    typedef uint32_t Node;
+    typedef Node Vector;
+    typedef Node Position;
+
+    static const Node root = 0;
+
+    struct PositionConnection;
+
+    struct PositionInfo
+    {
+        int nr;
+        int nr_vec_left;
+        long hotpos;
+        long needs_reducing;
+        PositionConnection* connections;
+        int sorted_index;
+    };
+
+    struct VectorInfo
+    {
+        char *name;
+        long nr;
+        long hot;
+    };
+
+    struct PositionConnection
+    {
+        long nr;
+        Position from_pos;
+        Position to_pos;
+        PositionConnection* next_con;
+        PositionConnection* next_from_con;
+        PositionConnection* next_to_con;
+        bool enabled;
+        Position other(Position p) { return p == from_pos ? to_pos : from_pos; }
+        PositionConnection* next(Position p) { return p == root ? next_con : p == from_pos ? next_from_con : next_to_con; }
+        PositionConnection** ref_to_next(Position p) { return p == root ? &next_con : p == from_pos ? &next_from_con : &next_to_con; }
+    };
+
+    struct Matrix
+    {
+        Matrix() : block(0), block_size(0) {}
+        void *block;
+        size_t block_size;
+        int nr_positions;
+        long nr_vectors;
+        Node nr_nodes;
+        Node first_vector;
+        PositionInfo *positions;
+        VectorInfo *vectors;
+        uint64_t *uncovered;
+        uint64_t uncovered_hash;
+        Position *sorted;
+        int *bucket_start;
+        Node *l;
+        Node *r;
+        Node *u;
+        Node *d;
+        Node *vector;
+        Node *position;
+    };
+
+    // Each thread works on its own copy of the matrix
+    Matrix matrix;
+    int nr_pos = 0;
+    int nr_vec = 0;
+    int nr_pos_with_zero_vec = 0;
+
+    // The selected vectors. As each covers at least one column, there is room
+    // for one vector per column (see build_matrix and copy_matrix).
+    std::vector<Vector> sol_vectors;
+    int nr_sol_vectors = 0;
+
+    inline PositionInfo& pos(Position position) { return matrix.positions[position - 1]; }
+    inline VectorInfo& vec(Vector vector) { return matrix.vectors[vector - matrix.first_vector]; }
+    inline Vector vector_with_nr(long nr) { return matrix.first_vector + (Node)(nr - 1); }
+    inline Position position_with_nr(long nr) { return (Position)(1 + nr); }
+    inline bool is_position(Node node) { return node < matrix.first_vector; }
+
+    inline void swapout_horz(Node n) { matrix.r[matrix.l[n]] = matrix.r[n]; matrix.l[matrix.r[n]] = matrix.l[n]; }
+    inline void swapin_horz(Node n) { matrix.r[matrix.l[n]] = n; matrix.l[matrix.r[n]] = n; }
+    inline void swapout_vert(Node n) { matrix.d[matrix.u[n]] = matrix.d[n]; matrix.u[matrix.d[n]] = matrix.u[n]; }
+    inline void swapin_vert(Node n) { matrix.d[matrix.u[n]] = n; matrix.u[matrix.d[n]] = n; }
+    inline bool swapped_out_horz(Node n) { return matrix.r[matrix.l[n]] != n; }
+
+    static uint64_t mix_hash(uint64_t x)
+    {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    // The set of uncovered positions is also kept as a bitset, together
+    // with a hash of it, which is the xor of the hashes of the positions.
+    static int nr_uncovered_words(int nr_positions) { return (nr_positions + 63) / 64; }
+
+    inline void toggle_uncovered(Position position)
+    {
+        int nr = pos(position).nr;
+        matrix.uncovered[nr / 64] ^= (uint64_t)1 << (nr % 64);
+        matrix.uncovered_hash ^= mix_hash(nr);
+    }
+
+    inline bool is_uncovered(Position position)
+    {
+        int nr = pos(position).nr;
+        return (matrix.uncovered[nr / 64] >> (nr % 64)) & 1;
+    }
+
+    // For the MRV heuristic, the positions are kept in the array sorted,
+    // ordered on a key, which is zero for covered positions and otherwise
+    // one more than the number of vectors left. The positions with key k are
+    // found from bucket_start[k] up to bucket_start[k+1]. When a key changes
+    // by one, the position is swapped with the first or last position of its
+    // bucket, after which the bucket boundary is moved.
+
+    inline bool use_buckets() { return opt_branch == BRANCH_MRV; }
+
+    inline void swap_sorted(int i, int j)
+    {
+        Position pi = matrix.sorted[i];
+        Position pj = matrix.sorted[j];
+        matrix.sorted[i] = pj;
+        matrix.sorted[j] = pi;
+        pos(pj).sorted_index = i;
+        pos(pi).sorted_index = j;
+    }
+
+    inline void decrease_key(Position position, int key)
+    {
+        swap_sorted(pos(position).sorted_index, matrix.bucket_start[key]++);
+    }
+
+    inline void increase_key(Position position, int key)
+    {
+        swap_sorted(pos(position).sorted_index, --matrix.bucket_start[key + 1]);
+    }
+
+    void bucket_cover(Position position)
+    {
+        for (int key = pos(position).nr_vec_left + 1; key > 0; key--)
+            decrease_key(position, key);
+    }
+
+    void bucket_uncover(Position position)
+    {
+        for (int key = 0; key <= pos(position).nr_vec_left; key++)
+            increase_key(position, key);
+    }
+
+    static void allocate_matrix(Matrix &m)
+    {
+        size_t nr_nodes = m.nr_nodes;
+        m.block_size =   m.nr_positions * sizeof(PositionInfo)
+                       + m.nr_vectors * sizeof(VectorInfo)
+                       + nr_uncovered_words(m.nr_positions) * sizeof(uint64_t)
+                       + m.nr_positions * sizeof(Position)
+                       + (m.nr_vectors + 3) * sizeof(int)
+                       + 6 * nr_nodes * sizeof(Node);
+        m.block = malloc(m.block_size);
+        if (m.block == 0)
+        {
+            fprintf(stderr, "Fatal error: Cannot allocate %lu bytes for the matrix\n", (unsigned long)m.block_size);
+            exit(1);
+        }
+        m.positions = (PositionInfo*)m.block;
+        m.vectors = (VectorInfo*)(m.positions + m.nr_positions);
+        m.uncovered = (uint64_t*)(m.vectors + m.nr_vectors);
+        m.sorted = (Position*)(m.uncovered + nr_uncovered_words(m.nr_positions));
+        m.bucket_start = (int*)(m.sorted + m.nr_positions);
+        m.l = (Node*)(m.bucket_start + m.nr_vectors + 3);
+        m.r = m.l + nr_nodes;
+        m.u = m.r + nr_nodes;
+        m.d = m.u + nr_nodes;
+        m.vector = m.d + nr_nodes;
+        m.position = m.vector + nr_nodes;
+    }
+
+    // Duplicate vectors
+    //
+    // Vectors with the same columns are merged when the input is read. The
+    // names of the removed vectors are kept as aliases of the vector that
+    // remains, and are only expanded when the solutions are passed to the
+    // visitor, with the numbers of the rows in the input. When counting,
+    // a solution counts for the product of the multiplicities (one plus the
+    // number of aliases) of its vectors. As the count table and -components
+    // deal with subproblems, they divide by the weight of the path to them.
+
+    long nr_duplicate_vectors = 0;
+    std::vector<char*> row_names; // the names of all the rows of the input
+    std::vector<uint32_t> vector_rows; // the row of each vector
+    std::vector<uint32_t> alias_rows;
+    std::vector<size_t> alias_start; // aliases of each vector in alias_rows
+    std::vector<int> alias_choice; // for each selected vector
+
+    inline size_t nr_aliases(Vector vector)
+    {
+        long nr = vec(vector).nr;
+        return alias_start[nr] - alias_start[nr - 1];
+    }
+
+    // The product of the multiplicities of the selected vectors
+    long path_weight()
+    {
+        long weight = 1;
+        if (nr_duplicate_vectors > 0)
+            for (int i = 0; i < nr_sol_vectors; i++)
+                weight *= 1 + nr_aliases(sol_vectors[i]);
+        return weight;
+    }
+
+    // The row of the i-th selected vector, for the current choice of aliases
+    inline uint32_t solution_row(int i)
+    {
+        long nr = vec(sol_vectors[i]).nr;
+        if (nr_duplicate_vectors == 0 || alias_choice[i] == 0)
+            return vector_rows[nr - 1];
+        return alias_rows[alias_start[nr - 1] + alias_choice[i] - 1];
+    }
+
+    // The name of a row of the input
+    inline const char *row_name(uint32_t row) const { return row_names[row]; }
+
+    // Moves to the next choice of aliases. Returns false after the last one.
+    bool next_alias_choice()
+    {
+        if (nr_duplicate_vectors == 0)
+            return false;
+        for (int i = 0; i < nr_sol_vectors; i++)
+        {
+            if ((size_t)alias_choice[i] < nr_aliases(sol_vectors[i]))
+            {
+                alias_choice[i]++;
+                return true;
+            }
+            alias_choice[i] = 0;
+        }
+        return false;
+    }
+
+    static bool same_columns(const MatrixInput &input, size_t v1, size_t v2)
+    {
+        size_t len = input.vector_start[v1 + 1] - input.vector_start[v1];
+        if (input.vector_start[v2 + 1] - input.vector_start[v2] != len)
+            return false;
+        const int *c1 = input.entries.data() + input.vector_start[v1];
+        const int *c2 = input.entries.data() + input.vector_start[v2];
+        for (size_t i = 0; i < len; i++)
+        {
+            size_t j = 0;
+            while (j < len && c2[j] != c1[i])
+                j++;
+            if (j == len)
+                return false;
+        }
+        return true;
+    }
+
+    // Merges the vectors with the same columns, using an open addressing hash
+    // table on the (order independent) hash of the columns
+    void merge_duplicate_vectors(MatrixInput &input)
+    {
+        size_t nr_vectors = input.names.size();
+        row_names = input.names;
+        vector_rows.resize(nr_vectors);
+        for (size_t v = 0; v < nr_vectors; v++)
+            vector_rows[v] = v;
+        alias_start.assign(nr_vectors + 1, 0);
+        if (opt_keep_duplicates || nr_vectors == 0)
+            return;
+        
+        size_t table_size = 1;
+        while (table_size < 2 * nr_vectors)
+            table_size *= 2;
+        std::vector<long> table(table_size, -1); // the new number of a vector
+        std::vector<long> original(nr_vectors, -1); // the vector an alias belongs to
+        
+        MatrixInput merged;
+        merged.nr_positions = input.nr_positions;
+        merged.entries.reserve(input.entries.size());
+        std::vector<size_t> first_of; // the input vector of each merged vector
+        for (size_t v = 0; v < nr_vectors; v++)
+        {
+            uint64_t hash = 0;
+            for (size_t j = input.vector_start[v]; j < input.vector_start[v + 1]; j++)
+                hash ^= mix_hash(input.entries[j]);
+            size_t h = hash & (table_size - 1);
+            while (table[h] >= 0 && !same_columns(input, first_of[table[h]], v))
+                h = (h + 1) & (table_size - 1);
+            if (table[h] >= 0)
+            {
+                original[v] = table[h];
+                continue;
+            }
+            table[h] = first_of.size();
+            first_of.push_back(v);
+            merged.entries.insert(merged.entries.end(), input.entries.begin() + input.vector_start[v], input.entries.begin() + input.vector_start[v + 1]);
+            merged.add_vector(input.names[v]);
+        }
+        nr_duplicate_vectors = nr_vectors - first_of.size();
+        if (nr_duplicate_vectors == 0)
+            return;
+        
+        alias_start.assign(first_of.size() + 1, 0);
+        for (size_t v = 0; v < nr_vectors; v++)
+            if (original[v] >= 0)
+                alias_start[original[v] + 1]++;
+        for (size_t i = 0; i < first_of.size(); i++)
+            alias_start[i + 1] += alias_start[i];
+        alias_rows.resize(nr_duplicate_vectors);
+        std::vector<size_t> next(alias_start.begin(), alias_start.end() - 1);
+        for (size_t v = 0; v < nr_vectors; v++)
+            if (original[v] >= 0)
+                alias_rows[next[original[v]]++] = v;
+        vector_rows.assign(first_of.begin(), first_of.end());
+        if (flog != 0) fprintf(flog, "Merged %ld duplicate vectors\n", nr_duplicate_vectors);
+        
+        input.entries.swap(merged.entries);
+        input.vector_start.swap(merged.vector_start);
+        input.names.swap(merged.names);
+    }
+
+    // A vector that lists a column more than once cannot be put in the matrix
+    // (and would make same_columns match vectors with different columns)
+    void check_vectors(const MatrixInput &input)
+    {
+        std::vector<long> last_vector(input.nr_positions, -1);
+        for (size_t v = 0; v < input.names.size(); v++)
+            for (size_t j = input.vector_start[v]; j < input.vector_start[v + 1]; j++)
+            {
+                int column = input.entries[j];
+                if (last_vector[column] == (long)v)
+                {
+                    fprintf(stderr, "Error: Row %lu (%s) has column %d more than once\n", (unsigned long)v + 1, input.names[v], column);
+                    exit(1);
+                }
+                last_vector[column] = v;
+            }
+    }
+
+    void build_matrix(MatrixInput &input)
+    {
+        check_vectors(input);
+        merge_duplicate_vectors(input);
+        
+        Matrix &m = matrix;
+        m.nr_positions = input.nr_positions;
+        m.nr_vectors = input.names.size();
+        m.first_vector = 1 + m.nr_positions;
+        m.nr_nodes = m.first_vector + m.nr_vectors + input.entries.size();
+        allocate_matrix(m);
+        
+        m.l[root] = m.r[root] = m.u[root] = m.d[root] = root;
+        for (int i = 0; i < nr_uncovered_words(m.nr_positions); i++)
+            m.uncovered[i] = 0;
+        m.uncovered_hash = 0;
+        
+        for (int i = 0; i < m.nr_positions; i++)
+        {
+            Position position = 1 + i;
+            m.l[position] = m.l[root];
+            m.r[position] = root;
+            m.r[m.l[root]] = position;
+            m.l[root] = position;
+            m.u[position] = m.d[position] = position;
+            m.vector[position] = root;
+            m.position[position] = position;
+            pos(position).nr = i;
+            pos(position).nr_vec_left = 0;
+            pos(position).hotpos = 0;
+            pos(position).needs_reducing = 0;
+            pos(position).connections = 0;
+            toggle_uncovered(position);
+        }
+        nr_pos = m.nr_positions;
+        nr_pos_with_zero_vec = nr_pos;
+        sol_vectors.resize(m.nr_positions);
+        
+        Node node = m.first_vector + m.nr_vectors;
+        for (long i = 0; i < m.nr_vectors; i++)
+        {
+            Vector vector = m.first_vector + i;
+            m.u[vector] = m.u[root];
+            m.d[vector] = root;
+            m.d[m.u[root]] = vector;
+            m.u[root] = vector;
+            m.l[vector] = m.r[vector] = vector;
+            m.vector[vector] = vector;
+            m.position[vector] = root;
+            vec(vector).name = input.names[i];
+            vec(vector).nr = i + 1;
+            vec(vector).hot = 1;
+            
+            for (size_t j = input.vector_start[i]; j < input.vector_start[i+1]; j++, node++)
+            {
+                Position position = 1 + input.entries[j];
+                m.l[node] = m.l[vector];
+                m.r[node] = vector;
+                m.r[m.l[vector]] = node;
+                m.l[vector] = node;
+                m.u[node] = m.u[position];
+                m.d[node] = position;
+                m.d[m.u[position]] = node;
+                m.u[position] = node;
+                m.vector[node] = vector;
+                m.position[node] = position;
+                if (pos(position).nr_vec_left++ == 0)
+                    nr_pos_with_zero_vec--;
+            }
+        }
+        nr_vec = m.nr_vectors;
+        
+        // Counting sort on the keys
+        for (long k = 0; k < m.nr_vectors + 3; k++)
+            m.bucket_start[k] = 0;
+        for (Position position = 1; position <= (Position)m.nr_positions; position++)
+            m.bucket_start[pos(position).nr_vec_left + 2]++;
+        for (long k = 1; k < m.nr_vectors + 3; k++)
+            m.bucket_start[k] += m.bucket_start[k - 1];
+        for (Position position = 1; position <= (Position)m.nr_positions; position++)
+        {
+            int i = m.bucket_start[pos(position).nr_vec_left + 1]++;
+            m.sorted[i] = position;
+            pos(position).sorted_index = i;
+        }
+        for (long k = m.nr_vectors + 2; k > 0; k--)
+            m.bucket_start[k] = m.bucket_start[k - 1];
+        m.bucket_start[0] = 0;
+    }
+
+    // Symmetry breaking
+    //
+    // With -symmetry=file a group of permutations of the columns is read,
+    // one permutation per line, under which the set of solutions does not
+    // change (such as the rotations and reflections of the board written by
+    // 'pianofrac symmetry'). Of each set of solutions that are mapped onto
+    // each other, only one is written: the one with the lowest key. The key
+    // of a solution is the number of the vector covering sym_column followed
+    // by the sorted numbers of all its vectors. During the search a branch
+    // is cut as soon as for some permutation g the image of the vector that
+    // covers g^-1(sym_column) has a lower number than the vector that covers
+    // sym_column.
+
+    std::vector<std::vector<int> > sym_perms;
+    int sym_column = -1;
+    std::vector<int> sym_pre_column;      // g^-1(sym_column) for each g
+    std::vector<long> sym_image;          // image of each vector for each g
+    std::vector<size_t> sym_vector_start; // the columns of each vector
+    std::vector<int> sym_entries;
+    std::vector<long> sym_cover; // vector covering each column
+
+    void read_symmetry(const char *file_name)
+    {
+        FILE *f = fopen(file_name, "rt");
+        if (f == 0)
+        {
+            fprintf(stderr, "Error: Cannot open symmetry file %s\n", file_name);
+            exit(1);
+        }
+        ECMappedFile file;
+        const char *error = file.open(f);
+        if (error != 0)
+        {
+            fprintf(stderr, "Error: %s\n", error);
+            exit(1);
+        }
+        const char *end = file.data() + file.size();
+        for (const char *s = file.data(); s < end;)
+        {
+            std::vector<int> perm;
+            for (; s < end && *s != '\n';)
+                if (isdigit(*s))
+                {
+                    int nr = 0;
+                    while (s < end && isdigit(*s))
+                        nr = 10 * nr + *s++ - '0';
+                    perm.push_back(nr);
+                }
+                else
+                    s++;
+            s++;
+            if (perm.size() > 0)
+                sym_perms.push_back(perm);
+        }
+        fclose(f);
+    }
+
+    void init_symmetry(MatrixInput &input)
+    {
+        int nr_sym = sym_perms.size();
+        for (int g = 0; g < nr_sym; g++)
+        {
+            std::vector<int> &perm = sym_perms[g];
+            std::vector<bool> found(input.nr_positions, false);
+            bool correct = (int)perm.size() == input.nr_positions;
+            for (size_t i = 0; correct && i < perm.size(); i++)
+            {
+                correct = perm[i] < input.nr_positions && !found[perm[i]];
+                if (correct)
+                    found[perm[i]] = true;
+            }
+            if (!correct)
+            {
+                fprintf(stderr, "Error: Line %d of the symmetry file is not a permutation of the %d columns\n", g + 1, input.nr_positions);
+                exit(1);
+            }
+        }
+        for (int g = 0; g < nr_sym; g++)
+            for (int h = 0; h < nr_sym; h++)
+            {
+                std::vector<int> composed(input.nr_positions);
+                for (int i = 0; i < input.nr_positions; i++)
+                    composed[i] = sym_perms[g][sym_perms[h][i]];
+                bool found = false;
+                for (int k = 0; k < nr_sym && !found; k++)
+                    found = sym_perms[k] == composed;
+                if (!found)
+                {
+                    fprintf(stderr, "Error: The permutations of the symmetry file do not form a group\n");
+                    exit(1);
+                }
+            }
+        
+        // Only keep the permutations that map the vectors onto vectors. These
+        // form a subgroup.
+        long nr_vectors = input.names.size();
+        std::map<std::vector<int>, long> vector_with_columns;
+        for (long v = 0; v < nr_vectors; v++)
+        {
+            std::vector<int> columns(input.entries.begin() + input.vector_start[v], input.entries.begin() + input.vector_start[v+1]);
+            std::sort(columns.begin(), columns.end());
+            vector_with_columns[columns] = v + 1;
+        }
+        std::vector<std::vector<long> > images;
+        std::vector<std::vector<int> > perms;
+        for (int g = 0; g < nr_sym; g++)
+        {
+            std::vector<long> image(nr_vectors);
+            long v;
+            for (v = 0; v < nr_vectors; v++)
+            {
+                std::vector<int> columns;
+                for (size_t j = input.vector_start[v]; j < input.vector_start[v+1]; j++)
+                    columns.push_back(sym_perms[g][input.entries[j]]);
+                std::sort(columns.begin(), columns.end());
+                std::map<std::vector<int>, long>::iterator it = vector_with_columns.find(columns);
+                if (it == vector_with_columns.end())
+                    break;
+                image[v] = it->second;
+            }
+            if (v < nr_vectors)
+            {
+                fprintf(stderr, "Warning: Line %d of the symmetry file is ignored, because it does not map vector '%s' onto a vector\n", g + 1, input.names[v]);
+                continue;
+            }
+            perms.push_back(sym_perms[g]);
+            images.push_back(image);
+        }
+        sym_perms = perms;
+        nr_sym = sym_perms.size();
+        if (flog != 0) fprintf(flog, "Using %d symmetries\n", nr_sym);
+        
+        sym_image.resize(nr_vectors * nr_sym);
+        for (long v = 0; v < nr_vectors; v++)
+            for (int g = 0; g < nr_sym; g++)
+                sym_image[v * nr_sym + g] = images[g][v];
+        sym_vector_start = input.vector_start;
+        sym_entries = input.entries;
+        
+        // Select the column that is mapped onto itself by most permutations
+        int best_nr_fixed = -1;
+        for (int i = 0; i < input.nr_positions; i++)
+        {
+            int nr_fixed = 0;
+            for (int g = 0; g < nr_sym; g++)
+                if (sym_perms[g][i] == i)
+                    nr_fixed++;
+            if (nr_fixed > best_nr_fixed)
+            {
+                sym_column = i;
+                best_nr_fixed = nr_fixed;
+            }
+        }
+        sym_pre_column.resize(nr_sym);
+        for (int g = 0; g < nr_sym; g++)
+            for (int i = 0; i < input.nr_positions; i++)
+                if (sym_perms[g][i] == sym_column)
+                    sym_pre_column[g] = i;
+    }
+
+    void print(FILE *f)
+    {
+        for (Vector vector = matrix.d[root]; vector != root; vector = matrix.d[vector])
+        {
+            Node node = matrix.r[vector];
+            
+            for (Position position = matrix.r[root]; position != root; position = matrix.r[position])
+            {
+                if (node != vector && matrix.position[node] == position)
+                {
+                    fprintf(f, "1");
+                    node = matrix.r[node];
+                }
+                else
+                    fprintf(f, "0");
+            }
+            if (vec(vector).name[0] != '\0')
+                fprintf(f, " %s\n", vec(vector).name);
+            else
+                fprintf(f, "\n");
+        }
+    }
+
+    void print_numeric(FILE *f)
+    {
+        for (Vector vector = matrix.d[root]; vector != root; vector = matrix.d[vector])
+        {
+            Node node = matrix.r[vector];
+            
+            int pos_nr = 0;
+            bool first = true;
+            for (Position position = matrix.r[root]; position != root; position = matrix.r[position], pos_nr++)
+            {
+                if (node != vector && matrix.position[node] == position)
+                {
+                    if (!first)
+                        fprintf(f, ",");
+                    first = false;
+                    fprintf(f, "%d", pos_nr);
+                    node = matrix.r[node];
+                }
+            }
+            if (vec(vector).name[0] != '\0')
+                fprintf(f, " %s\n", vec(vector).name);
+            else
+                fprintf(f, "\n");
+        }
+    }
+
+    // During the reduction, the matrix is written every 300 seconds, to
+    // backup1.ec and backup2.ec in turn
+    clock_t backup_time = 0;
+    int backup_nr = 0;
+
+    void backup()
+    {
+        if (clock() - backup_time > 300000)
+        {
+            const char *backupfilename = backup_nr == 0 ? "backup1.ec" : "backup2.ec";
+            backup_nr = (backup_nr+1)%2;
+            if (flog != 0) fprintf(flog, "Start creating %s\n", backupfilename);
+            FILE* f = fopen(backupfilename, "wt");
+            print_numeric(f);
+            fclose(f);
+            if (flog != 0) fprintf(flog, "Finished creating %s\n", backupfilename);
+            backup_time = clock();
+        }
+    }
+
+    // Work queue for the reduction drivers, which repeatedly take the position
+    // with the smallest score. It is an indexed binary heap, ordered on score
+    // and then on position, which is the order of the positions in the matrix.
+    // While a queue is attached as position_queue, it is updated for each
+    // position that is changed by ignoring or unignoring vectors and positions.
+
+    class PositionQueue
+    {
+    public:
+        PositionQueue(ECEngine &engine, long (ECEngine::*score)(Position), bool (ECEngine::*is_member)(Position))
+          : _engine(engine), _score(score), _is_member(is_member), _index(engine.matrix.nr_positions + 1, -1) {}
+        
+        bool empty() const { return _heap.empty(); }
+        Position top() const { return _heap[0].position; }
+        long top_score() const { return _heap[0].score; }
+        
+        // Returns the number of positions with the score of the top position
+        int nr_with_top_score() const { return empty() ? 0 : nr_with_score(0, top_score()); }
+        
+        // Adds, moves or removes the position according to its current score
+        void update(Position position)
+        {
+            if (!(_engine.*_is_member)(position))
+            {
+                remove(position);
+                return;
+            }
+            int i = _index[position];
+            if (i < 0)
+            {
+                i = _heap.size();
+                _heap.push_back(Entry());
+            }
+            _heap[i].score = (_engine.*_score)(position);
+            _heap[i].position = position;
+            _index[position] = i;
+            sift_down(sift_up(i));
+        }
+        
+        void remove(Position position)
+        {
+            int i = _index[position];
+            if (i < 0)
+                return;
+            _index[position] = -1;
+            Entry last = _heap.back();
+            _heap.pop_back();
+            if (i < (int)_heap.size())
+            {
+                _heap[i] = last;
+                _index[last.position] = i;
+                sift_down(sift_up(i));
+            }
+        }
+
+    private:
+        struct Entry
+        {
+            long score;
+            Position position;
+            bool operator<(const Entry &rhs) const { return score < rhs.score || (score == rhs.score && position < rhs.position); }
+        };
+        
+        int nr_with_score(size_t i, long score) const
+        {
+            if (i >= _heap.size() || _heap[i].score != score)
+                return 0;
+            return 1 + nr_with_score(2*i + 1, score) + nr_with_score(2*i + 2, score);
+        }
+        
+        void place(int i, const Entry &entry)
+        {
+            _heap[i] = entry;
+            _index[entry.position] = i;
+        }
+        
+        int sift_up(int i)
+        {
+            Entry entry = _heap[i];
+            for (; i > 0 && entry < _heap[(i - 1)/2]; i = (i - 1)/2)
+                place(i, _heap[(i - 1)/2]);
+            place(i, entry);
+            return i;
+        }
+        
+        void sift_down(int i)
+        {
+            Entry entry = _heap[i];
+            int n = _heap.size();
+            for (int child; (child = 2*i + 1) < n; i = child)
+            {
+                if (child + 1 < n && _heap[child + 1] < _heap[child])
+                    child++;
+                if (!(_heap[child] < entry))
+                    break;
+                place(i, _heap[child]);
+            }
+            place(i, entry);
+        }
+        
+        ECEngine &_engine;
+        long (ECEngine::*_score)(Position);
+        bool (ECEngine::*_is_member)(Position);
+        std::vector<Entry> _heap;
+        std::vector<int> _index;
+    };
+
+    PositionQueue *position_queue = 0;
+
+    inline void update_position_queue(Position position)
+    {
+        if (position_queue != 0)
+            position_queue->update(position);
+    }
+
+    void ignoreVector(Vector vector, Position exclude, bool mark_as_hot = false)
+    {
+        swapout_vert(vector);
+        
+        for (Node node = matrix.r[vector]; node != vector; node = matrix.r[node])
+        {
+            Position position = matrix.position[node];
+            if (mark_as_hot)
+            {
+                if (pos(position).hotpos == 0)
+                    for (Node node2 = matrix.d[position]; node2 != position; node2 = matrix.d[node2])
+                        vec(matrix.vector[node2]).hot++;
+                pos(position).hotpos++;
+                pos(position).needs_reducing++;
+            }
+            if (position != exclude)
+            {
+                swapout_vert(node);
+                pos(position).needs_reducing++;
+                if (use_buckets())
+                    decrease_key(position, pos(position).nr_vec_left + 1);
+                if (--pos(position).nr_vec_left == 0)
+                    nr_pos_with_zero_vec++;
+            }
+            update_position_queue(position);
+        }
+    }
+
+    void unignoreVector(Vector vector, Position exclude)
+    {
+        for (Node node = matrix.l[vector]; node != vector; node = matrix.l[node])
+        {
+            Position position = matrix.position[node];
+            if (position != exclude)
+            {
+                swapin_vert(node);
+                if (use_buckets())
+                    increase_key(position, pos(position).nr_vec_left + 1);
+                if (pos(position).nr_vec_left++ == 0)
+                    nr_pos_with_zero_vec--;
+                update_position_queue(position);
+            }
+        }
+
+        swapin_vert(vector);
+    }
+
+    void selectPosition(Position position, Vector exclude)
+    {
+        nr_covers++;
+        swapout_horz(position);
+        toggle_uncovered(position);
+        if (use_buckets())
+            bucket_cover(position);
+        
+        for (Node node = matrix.d[position]; node != position; node = matrix.d[node])
+        {
+            if (matrix.vector[node] != exclude)
+                ignoreVector(matrix.vector[node], position);
+        }
+    }
+
+    void unselectPosition(Position position, Vector exclude)
+    {
+        for (Node node = matrix.u[position]; node != position; node = matrix.u[node])
+        {
+            if (matrix.vector[node] != exclude)
+                unignoreVector(matrix.vector[node], position);
+        }
+
+        swapin_horz(position);
+        toggle_uncovered(position);
+        if (use_buckets())
+            bucket_uncover(position);
+        nr_uncovers++;
+    }
+
+    void selectVector(Vector vector)
+    {
+        swapout_vert(vector);
+        
+        for (Node node = matrix.r[vector]; node != vector; node = matrix.r[node])
+            selectPosition(matrix.position[node], vector);
+    }
+
+    void unselectVector(Vector vector)
+    {
+        for (Node node = matrix.l[vector]; node != vector; node = matrix.l[node])
+            unselectPosition(matrix.position[node], vector);
+
+        swapin_vert(vector);
+    }
+
+    // Set when ignoring a column or restoring vectors, because this makes
+    // the nogoods of possible() invalid (see nogood_table)
+    bool nogood_table_stale = false;
+
+    void ignorePosition(Position position)
+    {
+        nogood_table_stale = true;
+        if (pos(position).nr_vec_left == 0)
+            nr_pos_with_zero_vec--;
+            
+        swapout_horz(position);
+        toggle_uncovered(position);
+        if (use_buckets())
+            bucket_cover(position);
+        
+        for (Node node = matrix.d[position]; node != position; node = matrix.d[node])
+            swapout_horz(node);
+        if (position_queue != 0)
+            position_queue->remove(position);
+    }
+
+    void unignorePosition(Position position)
+    {
+        nogood_table_stale = true;
+        for (Node node = matrix.u[position]; node != position; node = matrix.u[node])
+            swapin_horz(node);
+
+        swapin_horz(position);
+        toggle_uncovered(position);
+        if (use_buckets())
+            bucket_uncover(position);
+
+        if (pos(position).nr_vec_left == 0)
+            nr_pos_with_zero_vec++;
+        update_position_queue(position);
+    }
+
+    // Log of ignored vectors and positions, which are restored (in reverse
+    // order) when it goes out of scope.
+    class IgnoredNodes
+    {
+    public:
+        IgnoredNodes(ECEngine &engine) : _engine(engine) {}
+        
+        void add(Node node, bool mark_as_hot = false)
+        {
+            Ignored ignored;
+            ignored.is_position = _engine.is_position(node);
+            ignored.node = node;
+            _ignored.push_back(ignored);
+            
+            if (ignored.is_position)
+            {
+                _engine.ignorePosition(node);
+                _engine.nr_pos--;
+            }
+            else
+            {
+                _engine.ignoreVector(node, root, mark_as_hot);
+                _engine.nr_vec--;
+            }
+        }
+        
+        ~IgnoredNodes()
+        {
+            if (!_ignored.empty())
+                _engine.nogood_table_stale = true;
+            for (size_t i = _ignored.size(); i-- > 0;)
+                if (_ignored[i].is_position)
+                {
+                    _engine.unignorePosition(_ignored[i].node);
+                    _engine.nr_pos++;
+                }
+                else
+                {
+                    _engine.unignoreVector(_ignored[i].node, root);
+                    _engine.nr_vec++;
+                }
+        }
+        
+        size_t size() const { return _ignored.size(); }
+        
+        // Ignores the nodes from the given index on again, in the matrix of
+        // another engine, which was copied before they were ignored.
+        void replay(ECEngine &engine, size_t from) const
+        {
+            for (size_t i = from; i < _ignored.size(); i++)
+                if (_ignored[i].is_position)
+                {
+                    engine.ignorePosition(_ignored[i].node);
+                    engine.nr_pos--;
+                }
+                else
+                {
+                    engine.ignoreVector(_ignored[i].node, root);
+                    engine.nr_vec--;
+                }
+        }
+
+    private:
+        struct Ignored
+        {
+            bool is_position;
+            Node node;
+        };
+        ECEngine &_engine;
+        std::vector<Ignored> _ignored;
+    };
+
+    // For reduce(), the vectors of position1 are marked in a bitset. Each
+    // column that is equal to position1 or implied by it, contains the first
+    // vector of position1. So, only the other positions of this vector are
+    // candidates. Whether a candidate contains all vectors of position1, and
+    // which of its vectors do not belong to position1, is found with a single
+    // walk over the list of the candidate.
+
+    std::vector<uint64_t> reduce_marks;
+
+    inline void mark_vectors(Position position, bool on)
+    {
+        if (reduce_marks.size() < (size_t)(matrix.nr_vectors + 63) / 64)
+            reduce_marks.resize((matrix.nr_vectors + 63) / 64, 0);
+        for (Node node = matrix.d[position]; node != position; node = matrix.d[node])
+        {
+            long i = vec(matrix.vector[node]).nr - 1;
+            if (on)
+                reduce_marks[i / 64] |= (uint64_t)1 << (i % 64);
+            else
+                reduce_marks[i / 64] &= ~((uint64_t)1 << (i % 64));
+        }
+    }
+
+    inline bool is_marked(Vector vector)
+    {
+        long i = vec(vector).nr - 1;
+        return (reduce_marks[i / 64] >> (i % 64)) & 1;
+    }
+
+    // Returns the number of vectors of the position that are marked
+    int nr_marked_vectors(Position position)
+    {
+        int nr = 0;
+        for (Node node = matrix.d[position]; node != position; node = matrix.d[node])
+            if (is_marked(matrix.vector[node]))
+                nr++;
+        return nr;
+    }
+
+    bool reduce(Position position1, IgnoredNodes &ignoredNodes, bool mark_as_hot = false)
+    {
+        bool progress = false;
+        
+        if (flog != 0 && tracePrint())
+            fprintf(flog, "Processing position %d\n", pos(position1).nr);
+        
+        if (swapped_out_horz(position1))
+        {
+            fprintf(stderr, "Fatal error: Position1 %d swapped out\n", pos(position1).nr);
+            exit(1);
+        }
+        if (pos(position1).nr_vec_left == 0)
+        {
+            if (flog != 0) fprintf(flog, "Impossible\n");
+            return progress; // -- no solution possible
+        }
+        
+        std::vector<Position> candidates;
+        Vector first_vector = matrix.vector[matrix.d[position1]];
+        for (Node node = matrix.r[first_vector]; node != first_vector; node = matrix.r[node])
+            if (matrix.position[node] != position1)
+                candidates.push_back(matrix.position[node]);
+        
+        mark_vectors(position1, true);
+        int nr_vec1 = pos(position1).nr_vec_left;
+
+        for (size_t i = 0; i < candidates.size(); i++)
+        {
+            Position position2 = candidates[i];
+            if (   swapped_out_horz(position2)
+                || pos(position2).nr_vec_left != nr_vec1
+                || nr_marked_vectors(position2) != nr_vec1)
+                continue;
+                
+            if (flog != 0) fprintf(flog, "Column %d equal with column %d. (%d)\n", pos(position1).nr, pos(position2).nr, nr_pos-1);
+            
+            ignoredNodes.add(position2);
+
+            if (nr_pos_with_zero_vec > 0)
+            {
+                fprintf(stderr, "Fatal error: Equal resulted in position(s) without vectors.\n");
+                for (Position position3 = matrix.r[root]; position3 != root; position3 = matrix.r[position3])
+                    if (pos(position3).nr_vec_left == 0)
+                        fprintf(stderr, "Position %d has no vectors left\n", pos(position3).nr);
+                exit(1);
+            }
+        }
+
+        for (size_t i = 0; i < candidates.size(); i++)
+        {
+            Position position2 = candidates[i];
+            if (   swapped_out_horz(position2)
+                || pos(position2).nr_vec_left <= nr_vec1
+                || nr_marked_vectors(position2) != nr_vec1)
+                continue;
+            
+            if (flog != 0) fprintf(flog, "Column %d implies column %d. Reduced number vectors with %d\n", pos(position1).nr, pos(position2).nr, pos(position2).nr_vec_left - pos(position1).nr_vec_left);  
+
+            // The vectors to remove are the ones of position2 that are not
+            // marked. Removing a vector does not change the links of the
+            // other vectors of the column.
+            Node next_node = 0;
+            for (Node node = matrix.d[position2]; node != position2; node = next_node)
+            {
+                next_node = matrix.d[node];
+                Vector vector = matrix.vector[node];
+                if (!is_marked(vector))
+                {
+                    if (flog != 0) fprintf(flog, "  remove: %s\n", vec(vector).name);
+
+                    ignoredNodes.add(vector, mark_as_hot);
+                }
+            }
+            
+            if (flog != 0) fprintf(flog, "Left %d.\n", nr_vec);
+            
+            progress = true;
+
+            if (nr_pos_with_zero_vec > 0)
+            {
+                if (flog != 0) fprintf(flog, "Reduction caused some positions to have no vectors anymore.\n");
+                for (Position position3 = matrix.r[root]; position3 != root; position3 = matrix.r[position3])
+                    if (pos(position3).nr_vec_left == 0)
+                    {
+                        if (flog != 0) fprintf(flog, "  Removed position %d\n", pos(position3).nr);
+                        ignoredNodes.add(position3);
+                    }
+                    
+                if (nr_pos_with_zero_vec > 0)
+                {
+                    fprintf(stderr, "Fatal error: Still some left???\n");
+                    exit(1);
+                }
+            }
+        }
+        
+        mark_vectors(position1, false);
+        
+        backup();
+        
+        return progress;
+    }
+
+    // The number of vectors that two positions have in common, is the number
+    // of bits in the AND of their vector bitsets. The bitset of a position
+    // only holds the words from its first to its last vector. The pairs are
+    // divided over the threads, each taking every nr_threads-th first position.
+
+    struct PositionBits
+    {
+        Position position;
+        long first_word;
+        long end_word;
+        size_t offset;
+    };
+
+    struct CommonVectors
+    {
+        CommonVectors(size_t n_other, long n_nr) : other(n_other), nr(n_nr) {}
+        size_t other;
+        long nr;
+    };
+
+    static void count_common_vectors(const std::vector<uint64_t> *bits, const std::vector<PositionBits> *position_bits,
+                                     std::vector<std::vector<CommonVectors> > *common, int thread_nr, int nr_threads)
+    {
+        size_t n = position_bits->size();
+        for (size_t i = thread_nr; i < n; i += nr_threads)
+        {
+            const PositionBits &bits1 = (*position_bits)[i];
+            for (size_t j = i + 1; j < n; j++)
+            {
+                const PositionBits &bits2 = (*position_bits)[j];
+                const uint64_t *words1 = bits->data() + bits1.offset - bits1.first_word;
+                const uint64_t *words2 = bits->data() + bits2.offset - bits2.first_word;
+                long end_word = std::min(bits1.end_word, bits2.end_word);
+                long nr_common = 0;
+                for (long w = std::max(bits1.first_word, bits2.first_word); w < end_word; w++)
+                    nr_common += __builtin_popcountll(words1[w] & words2[w]);
+                if (nr_common > 0)
+                    (*common)[i].push_back(CommonVectors(j, nr_common));
+            }
+        }
+    }
+
+    static bool more_common_vectors(const PositionConnection &a, const PositionConnection &b)
+    {
+        return a.nr > b.nr;
+    }
+
+    // The connections of a pass of reduce_groups(). They are replaced by the
+    // next pass, which reuses the memory.
+    std::vector<PositionConnection> position_connections;
+
+    // Returns the connections between all pairs of positions with vectors in
+    // common, sorted on decreasing number of common vectors, and links them
+    // in the same order in the lists of both positions.
+    PositionConnection* connect_positions()
+    {
+        std::vector<PositionBits> position_bits;
+        std::vector<uint64_t> bits;
+        for (Position position = matrix.r[root]; position != root; position = matrix.r[position])
+        {
+            pos(position).connections = 0;
+            
+            PositionBits pb;
+            pb.position = position;
+            pb.first_word = 0;
+            pb.end_word = 0;
+            pb.offset = bits.size();
+            if (matrix.d[position] != position)
+            {
+                pb.first_word = (vec(matrix.vector[matrix.d[position]]).nr - 1) / 64;
+                pb.end_word = (vec(matrix.vector[matrix.u[position]]).nr - 1) / 64 + 1;
+                bits.resize(bits.size() + pb.end_word - pb.first_word, 0);
+                for (Node node = matrix.d[position]; node != position; node = matrix.d[node])
+                {
+                    long i = vec(matrix.vector[node]).nr - 1;
+                    bits[pb.offset + i / 64 - pb.first_word] |= (uint64_t)1 << (i % 64);
+                }
+            }
+            position_bits.push_back(pb);
+        }
+        
+        std::vector<std::vector<CommonVectors> > common(position_bits.size());
+        if (opt_threads > 1)
+        {
+            std::vector<std::thread> threads;
+            for (int i = 0; i < opt_threads; i++)
+                threads.push_back(std::thread(count_common_vectors, &bits, &position_bits, &common, i, opt_threads));
+            for (int i = 0; i < opt_threads; i++)
+                threads[i].join();
+        }
+        else
+            count_common_vectors(&bits, &position_bits, &common, 0, 1);
+        
+        size_t nr_pos_cons = 0;
+        for (size_t i = 0; i < common.size(); i++)
+            nr_pos_cons += common[i].size();
+        position_connections.clear();
+        position_connections.reserve(nr_pos_cons);
+        for (size_t i = 0; i < common.size(); i++)
+            for (size_t k = 0; k < common[i].size(); k++)
+            {
+                PositionConnection new_pos_con;
+                new_pos_con.nr = common[i][k].nr;
+                new_pos_con.from_pos = position_bits[i].position;
+                new_pos_con.to_pos = position_bits[common[i][k].other].position;
+                position_connections.push_back(new_pos_con);
+            }
+        std::stable_sort(position_connections.begin(), position_connections.end(), more_common_vectors);
+        
+        // Append the connections at the end of each list
+        std::vector<PositionConnection**> last(matrix.nr_positions + 1);
+        for (Position position = matrix.r[root]; position != root; position = matrix.r[position])
+            last[position] = &pos(position).connections;
+        PositionConnection* all_pos_connections = 0;
+        PositionConnection** last_con = &all_pos_connections;
+        for (size_t i = 0; i < position_connections.size(); i++)
+        {
+            PositionConnection* pos_con = &position_connections[i];
+            *last_con = pos_con;
+            last_con = &pos_con->next_con;
+            *last[pos_con->from_pos] = pos_con;
+            last[pos_con->from_pos] = &pos_con->next_from_con;
+            *last[pos_con->to_pos] = pos_con;
+            last[pos_con->to_pos] = &pos_con->next_to_con;
+        }
+        *last_con = 0;
+        for (Position position = matrix.r[root]; position != root; position = matrix.r[position])
+            *last[position] = 0;
+        
+        return all_pos_connections;
+    }
+
+    bool reduce_groups(IgnoredNodes &ignoredNodes, bool mark_as_hot)
+    {
+        PhaseTimer phaseTimer(*this, "reduce_groups");
+        bool progress = false;
+
+        if (flog != 0) fprintf(flog, "Start reduce groups\n");
+        
+        PositionConnection* all_pos_connections = connect_positions();
+        std::vector<PositionConnection*> first_enabled_con(matrix.nr_positions + 1);
+            
+#define MAX_GROUP_SIZE 12
+#define MAX_GROUP_SIZE2 (1<<MAX_GROUP_SIZE)
+        
+        for (int group_size = 3; group_size <= MAX_GROUP_SIZE && !progress; group_size++)
+        {
+            if (flog != 0) fprintf(flog, "group size = %d\n", group_size);
+            
+            int group_size2 = 1 << group_size;
+            
+            long nr_pos_con = 0;
+            for (PositionConnection* pos_con = all_pos_connections; pos_con != 0; pos_con = pos_con->next_con)
+            {
+                pos_con->enabled = true;
+                nr_pos_con++;
+            }
+            
+            // Connections are only disabled, so the first enabled connection
+            // of each list is found by moving forward from the previous one.
+            PositionConnection* first_enabled = all_pos_connections;
+            for (Position position = matrix.r[root]; position != root; position = matrix.r[position])
+                first_enabled_con[position] = pos(position).connections;
+            
+            for (int gr = 0; gr < nr_pos_con/3; gr++)
+            {
+                //printf("Group %d\n", gr);
+                
+                int nr_con;
+                
+                Position positions[MAX_GROUP_SIZE];
+                
+                while (!first_enabled->enabled)
+                    first_enabled = first_enabled->next_con;
+                positions[0] = first_enabled->from_pos;
+                positions[1] = first_enabled->to_pos;
+                nr_con = first_enabled->nr;
+                first_enabled->enabled = false;
+
+                bool correct = true;
+                
+                for (int i = 2; i < group_size; i++)
+                {
+                    //printf("  add %d\n", i);
+                    
+                    Position best_pos = 0;
+                    long max_nr = 0;
+                    for (int j = 0; j < i; j++)
+                    {
+                        PositionConnection*& pos_con = first_enabled_con[positions[j]];
+                        while (pos_con != 0 && !pos_con->enabled)
+                            pos_con = pos_con->next(positions[j]);
+                        if (pos_con != 0 && (best_pos == 0 || max_nr < pos_con->nr))
+                        {
+                            Position new_pos = pos_con->other(positions[j]);
+                            
+                            for (int k = 0; k < i; k++)
+                                if (positions[k] == new_pos)
+                                    new_pos = 0;
+                            if (new_pos != 0)
+                            {
+                                best_pos = new_pos;
+                                max_nr = pos_con->nr;
+                            }
+                        }
+                    }
+                    
+                    if (best_pos == 0)
+                    {
+                        //printf("incorrect\n");
+                        correct = false;
+                        break;
+                    }
+                    
+                    positions[i] = best_pos;
+                    nr_con += max_nr;
+                }
+                
+                if (correct)
+                {
+                    if (flog != 0)
+                    {
+                        fprintf(flog, "group %d: ", gr);
+                        for (int i = 0; i < group_size; i++)
+                            fprintf(flog, " %d", pos(positions[i]).nr);
+                        fprintf(flog, " = %d. ", nr_con);
+                    }
+                                    
+                    long count[MAX_GROUP_SIZE2];
+                    bool possible[MAX_GROUP_SIZE2];
+                    
+                    for (int i = 0; i < group_size2; i++)
+                        count[i] = 0;
+                    int nr_possible = 1;
+                
+                    Node nodes[MAX_GROUP_SIZE];
+                    for (int i = 0; i < group_size; i++)
+                        nodes[i] = matrix.d[positions[i]];
+                        
+                    for (;;)
+                    {
+                        int min_vec_nr = -1;
+        
+                        for (int i = 0; i < group_size; i++)
+                            if (nodes[i] != positions[i] && (min_vec_nr == -1 || vec(matrix.vector[nodes[i]]).nr < min_vec_nr))
+                                min_vec_nr = vec(matrix.vector[nodes[i]]).nr;
+                                
+                        if (min_vec_nr == -1)
+                            break;
+                        
+                        int val = 0;
+                        for (int i = 0; i < group_size; i++)
+                            if (nodes[i] != positions[i] && vec(matrix.vector[nodes[i]]).nr == min_vec_nr)
+                            {
+                                val |= 1 << i;
+                                nodes[i] = matrix.d[nodes[i]];
+                            }
+                            
+                        count[val]++;
+                    }
+                    
+                    // A combination is possible when it is a disjoint union of
+                    // combinations that occur. One of these contains its lowest
+                    // position, so it is enough to try the subsets of the rest,
+                    // which takes O(3^group_size) steps for all combinations.
+                    possible[0] = true;
+                    for (int val = 1; val < group_size2; val++)
+                    {
+                        int low = val & -val;
+                        int rest = val ^ low;
+                        possible[val] = false;
+                        for (int sub = rest;; sub = (sub - 1) & rest)
+                        {
+                            if (count[low | sub] > 0 && possible[rest ^ sub])
+                            {
+                                possible[val] = true;
+                                break;
+                            }
+                            if (sub == 0)
+                                break;
+                        }
+                    }
+
+                    for (int i = 1; i < group_size2; i++)
+                    {
+                        //for (int j = 0; j < group_size; j++)
+                        //    printf("%c", (i & (1 << j)) ? '1' : '0');
+                        //printf(": %d %s ", count[i], possible[i] ? "t" : "f");
+                        if (possible[i])
+                            nr_possible++;
+                    }
+
+                    if (flog != 0) fprintf(flog, " nr possible = %d\n", nr_possible);
+                    
+                    bool something_to_reduce = false;
+                    bool to_be_reduced[MAX_GROUP_SIZE2];
+                    
+                    for (int i = 1; i < group_size2; i++)
+                    {
+                    	to_be_reduced[i] = count[i] > 0 && !possible[group_size2 - 1 - i];
+                        if (to_be_reduced[i])
+                        {
+                            if (flog != 0)
+                            {
+                                fprintf(flog, "- reduce %ld for:", count[i]);
+                                for (int j = 0; j < group_size; j++)
+                                    fprintf(flog, "%c", (i & (1 << j)) ? '1' : '0');
+                                fprintf(flog, "\n");
+                            }
+                                                    
+                            something_to_reduce = true;
+                        }
+                    }
+                        
+                    if (something_to_reduce)
+                    {
+                        for (int i = 0; i < group_size; i++)
+                            nodes[i] = matrix.d[positions[i]];
+                            
+                        for (;;)
+                        {
+                            Vector min_vec = 0;
+                            int min_vec_nr = -1;
+            
+                            for (int i = 0; i < group_size; i++)
+                                if (nodes[i] != positions[i] && (min_vec_nr == -1 || vec(matrix.vector[nodes[i]]).nr < min_vec_nr))
+                                {
+                                    min_vec = matrix.vector[nodes[i]];
+                                    min_vec_nr = vec(min_vec).nr;
+                                }
+                                    
+                            if (min_vec == 0)
+                                break;
+                            
+                            int val = 0;
+                            for (int i = 0; i < group_size; i++)
+                                if (nodes[i] != positions[i] && vec(matrix.vector[nodes[i]]).nr == min_vec_nr)
+                                {
+                                    val |= 1 << i;
+                                    nodes[i] = matrix.d[nodes[i]];
+                                }
+                                
+                            if (to_be_reduced[val])
+                            {
+                                if (flog != 0) fprintf(flog, "  remove: %s\n", vec(min_vec).name);
+                                ignoredNodes.add(min_vec, mark_as_hot);
+                                progress = true;
+                            }
+                        }
+                    }
+                }            
+            }
+        }
+        
+        return progress;
+    }
+
+    long reduce_score(Position position) { return pos(position).nr_vec_left - pos(position).needs_reducing; }
+    bool needs_reducing(Position position) { return pos(position).needs_reducing > 0; }
+
+    void reduce(IgnoredNodes &ignoredNodes, bool mark_as_hot = false)
+    {
+        PhaseTimer phaseTimer(*this, "reduce");
+        for (bool progress = true; progress;)
+        {
+            progress = false;
+            bool reducing_groups_useful = false;
+
+            PositionQueue queue(*this, &ECEngine::reduce_score, &ECEngine::needs_reducing);
+            for (Position position1 = matrix.r[root]; position1 != root; position1 = matrix.r[position1])
+                queue.update(position1);
+            position_queue = &queue;
+            
+            while (!queue.empty())
+            {
+                Position position_to_reduce = queue.top();
+                
+                if (reduce(position_to_reduce, ignoredNodes, mark_as_hot))
+                    reducing_groups_useful = true;
+                pos(position_to_reduce).needs_reducing = 0;
+                queue.update(position_to_reduce);
+            }
+            position_queue = 0;
+                        
+            if (reducing_groups_useful && opt_reduce_groups)
+                progress = reduce_groups(ignoredNodes, mark_as_hot);
+                
+        }
+        if (flog != 0) fprintf(flog, "done reducing\n");    
+    }
+
+    // Table with a result for sets of uncovered columns. The table has a
+    // fixed number of entries and a new result simply replaces the entry with
+    // the same index.
+
+    class CountTable
+    {
+    public:
+        CountTable(int nr_words, long nr_entries) : nr_hits(0), nr_misses(0), _nr_words(nr_words)
+        {
+            for (_size = 1; _size * 2 <= (size_t)nr_entries; _size *= 2)
+                ;
+            _keys.resize(_size * nr_words);
+            _hashes.resize(_size);
+            _counts.assign(_size, -1);
+        }
+        
+        bool lookup(const uint64_t *key, uint64_t hash, long &count)
+        {
+            size_t i = hash & (_size - 1);
+            if (   _counts[i] >= 0 && _hashes[i] == hash
+                && memcmp(&_keys[i * _nr_words], key, _nr_words * sizeof(uint64_t)) == 0)
+            {
+                nr_hits++;
+                count = _counts[i];
+                return true;
+            }
+            nr_misses++;
+            return false;
+        }
+        
+        void clear() { _counts.assign(_size, -1); }
+        
+        void store(const uint64_t *key, uint64_t hash, long count)
+        {
+            size_t i = hash & (_size - 1);
+            memcpy(&_keys[i * _nr_words], key, _nr_words * sizeof(uint64_t));
+            _hashes[i] = hash;
+            _counts[i] = count;
+        }
+        
+        long nr_hits;
+        long nr_misses;
+
+    private:
+        int _nr_words;
+        size_t _size;
+        std::vector<uint64_t> _keys;
+        std::vector<uint64_t> _hashes;
+        std::vector<long> _counts;
+    };
+
+    // Sets of uncovered columns for which possible() proved that there is no
+    // exact cover. These stay valid when vectors are removed, but not when a
+    // column is ignored or vectors are restored, after which the table is
+    // cleared before it is used again.
+    CountTable* nogood_table = 0;
+    long nr_nogood_hits = 0;
+    long nr_nogood_misses = 0;
+
+    long total_nr_calls = 0;
+    int nr_calls;
+
+    bool possible(int tries)
+    {
+        if (tries == 0)
+            return true;
+
+        nr_calls++;
+        total_nr_calls++;        
+        if (nr_pos_with_zero_vec > 0)
+            return false;
+        
+        if (nogood_table != 0)
+        {
+            if (nogood_table_stale)
+            {
+                nogood_table->clear();
+                nogood_table_stale = false;
+            }
+            long count;
+            if (nogood_table->lookup(matrix.uncovered, matrix.uncovered_hash, count))
+                return false;
+        }
+            
+        int min_nr_vec_left = 0;
+        Position sel_pos = 0;
+        
+        for (Position position = matrix.r[root]; position != root; position = matrix.r[position])
+            if (pos(position).nr_vec_left < min_nr_vec_left || sel_pos == 0)
+            {
+                sel_pos = position;
+                min_nr_vec_left = pos(position).nr_vec_left;
+                if (min_nr_vec_left == 1)
+                    break;
+            }
+        if (min_nr_vec_left == 0)
+            return true;
+            
+        tries /= min_nr_vec_left;
+        if (tries == 0)
+            return true;
+
+        IgnoredNodes ignoredNodes(*this);
+            
+        for (Node node = matrix.d[sel_pos]; node != sel_pos; node = matrix.d[node])
+        {
+            Vector vector = matrix.vector[node];
+
+            selectVector(vector);
+            
+            bool pos = possible(tries);
+            
+            unselectVector(vector);
+
+            if (pos)
+                return true;
+        }
+        
+        if (nogood_table != 0)
+            nogood_table->store(matrix.uncovered, matrix.uncovered_hash, 0);
+        return false;
+    }
+
+
+    clock_t start_time;
+    clock_t start_periode;
+    int sol_found_in_periode;
+
+    long nr_solutions = 0;
+
+    // When solving a component, see solve_components()
+    typedef std::vector<std::vector<Vector> > ComponentSolutions;
+    ComponentSolutions *component_solutions = 0;
+    int component_depth = 0;
+
+    // Records the columns covered by a selected vector and returns false, if
+    // the branch can be cut because of the symmetry. Each call has to be
+    // followed by a call to symmetry_unselect.
+    bool symmetry_select(Vector vector)
+    {
+        if (sym_perms.empty())
+            return true;
+        if (sym_cover.empty())
+            sym_cover.assign(matrix.nr_positions, 0);
+        
+        long nr = vec(vector).nr;
+        for (size_t j = sym_vector_start[nr-1]; j < sym_vector_start[nr]; j++)
+            sym_cover[sym_entries[j]] = nr;
+        
+        long cover = sym_cover[sym_column];
+        if (cover == 0)
+            return true;
+        int nr_sym = sym_perms.size();
+        for (int g = 0; g < nr_sym; g++)
+        {
+            long pre_cover = sym_cover[sym_pre_column[g]];
+            if (pre_cover != 0 && sym_image[(pre_cover-1) * nr_sym + g] < cover)
+                return false;
+        }
+        return true;
+    }
+
+    void symmetry_unselect(Vector vector)
+    {
+        if (sym_perms.empty())
+            return;
+        long nr = vec(vector).nr;
+        for (size_t j = sym_vector_start[nr-1]; j < sym_vector_start[nr]; j++)
+            sym_cover[sym_entries[j]] = 0;
+    }
+
+    // Returns whether the current solution has the lowest key of all its
+    // images
+    bool symmetry_canonical()
+    {
+        if (sym_perms.empty() || sym_cover.empty())
+            return true;
+        
+        int nr_sym = sym_perms.size();
+        std::vector<long> key;
+        for (int i = 0; i < nr_sol_vectors; i++)
+            key.push_back(vec(sol_vectors[i]).nr);
+        std::sort(key.begin(), key.end());
+        key.insert(key.begin(), sym_cover[sym_column]);
+        
+        std::vector<long> image_key;
+        for (int g = 0; g < nr_sym; g++)
+        {
+            image_key.clear();
+            for (int i = 0; i < nr_sol_vectors; i++)
+                image_key.push_back(sym_image[(vec(sol_vectors[i]).nr-1) * nr_sym + g]);
+            std::sort(image_key.begin(), image_key.end());
+            image_key.insert(image_key.begin(), sym_image[(sym_cover[sym_pre_column[g]]-1) * nr_sym + g]);
+            if (image_key < key)
+                return false;
+        }
+        return true;
+    }
+
+    // The visitor the solutions are passed to. When searching with multiple
+    // threads, the calls are serialized with solution_visitor_mutex. When the
+    // visitor stops the search, search_stopped is set, such that the other
+    // threads stop as well. (See Shared.)
+    std::vector<uint32_t> solution_rows;
+
+    long nr_calls_to_solve = 0;
+
+    // Counting with memoization
+    //
+    // The number of solutions of a subproblem only depends on the set of
+    // uncovered columns, if the vectors that are ignored in the frames of
+    // solve() all contain the column of their frame, which is covered in
+    // the subproblems below it. For this reason, a frame does not select
+    // another column after ignoring a vector, when counting. (See CountTable.)
+
+    CountTable* count_table = 0;
+    long nr_count_hits = 0;
+    long nr_count_misses = 0;
+
+    // The number of frames whose remaining branches were taken by another
+    // worker. A subproblem that lost branches may not be stored.
+    long nr_stolen_frames = 0;
+
+    // The vectors that are ignored by a stolen task are also missing from
+    // the subproblems in which all their columns are still uncovered. Such
+    // a subproblem may not be looked up or stored.
+    std::vector<Vector> task_ignored;
+
+    bool has_covered_position(Vector vector)
+    {
+        for (Node node = matrix.r[vector]; node != vector; node = matrix.r[node])
+            if (!is_uncovered(matrix.position[node]))
+                return true;
+        return false;
+    }
+
+    bool may_memoize()
+    {
+        for (size_t i = 0; i < task_ignored.size(); i++)
+            if (!has_covered_position(task_ignored[i]))
+                return false;
+        return true;
+    }
+
+    // Solving with multiple threads
+    //
+    // The search is divided with work stealing. Each worker thread has its
+    // own copy of the matrix. A subtree of the search is described by the
+    // sequence of vectors that are selected (positive numbers) and ignored
+    // (negative numbers) to reach it. Each worker publishes this path for
+    // the top MAX_STEAL_DEPTH frames of its search. An idle worker can take
+    // the remaining branches of such a frame, by replaying the path with the
+    // vector that is currently being explored in that frame ignored.
+
+#define MAX_STEAL_DEPTH 12
+
+    struct Worker
+    {
+        Worker() : nr_frames(0), nr_solutions(0), nr_calls_to_solve(0), nr_propagated(0), nr_tasks(0), nr_count_hits(0), nr_count_misses(0) {}
+        std::mutex mutex;
+        std::vector<int> path;
+        struct
+        {
+            size_t start;
+            bool can_split;
+            bool stolen;
+        } frames[MAX_STEAL_DEPTH];
+        int nr_frames;
+        
+        long nr_solutions;
+        long nr_calls_to_solve;
+        long nr_propagated;
+        long nr_tasks;
+        long nr_count_hits;
+        long nr_count_misses;
+        std::vector<DepthProfile> depth_profile;
+
+        bool steal(std::vector<int> &task)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (int f = 0; f < nr_frames; f++)
+                if (frames[f].can_split && !frames[f].stolen)
+                {
+                    // The last path element of the frame is the vector
+                    // currently being explored
+                    size_t end = f + 1 < nr_frames ? frames[f+1].start : path.size();
+                    task.assign(path.begin(), path.begin() + end);
+                    task.back() = -task.back();
+                    frames[f].stolen = true;
+                    return true;
+                }
+            return false;
+        }
+    };
+
+    Worker* cur_worker = 0;
+
+    // Publishes a frame of solve() on the path of the current worker, if
+    // it is one of the top frames.
+    class PublishedFrame
+    {
+    public:
+        PublishedFrame(ECEngine &engine) : _engine(engine), _worker(engine.cur_worker)
+        {
+            if (_worker == 0)
+                return;
+            if (_worker->nr_frames == MAX_STEAL_DEPTH)
+            {
+                _worker = 0;
+                return;
+            }
+            std::lock_guard<std::mutex> lock(_worker->mutex);
+            _frame = _worker->nr_frames++;
+            _worker->frames[_frame].start = _worker->path.size();
+            _worker->frames[_frame].can_split = false;
+            _worker->frames[_frame].stolen = false;
+        }
+        ~PublishedFrame()
+        {
+            if (_worker == 0)
+                return;
+            std::lock_guard<std::mutex> lock(_worker->mutex);
+            _worker->path.resize(_worker->frames[_frame].start);
+            _worker->nr_frames--;
+        }
+        void select(Vector vector, bool can_split)
+        {
+            if (_worker == 0)
+                return;
+            std::lock_guard<std::mutex> lock(_worker->mutex);
+            _worker->path.push_back(_engine.vec(vector).nr);
+            _worker->frames[_frame].can_split = can_split;
+        }
+        // Returns true, when the remaining branches have been stolen
+        bool unselect()
+        {
+            if (_worker == 0)
+                return false;
+            std::lock_guard<std::mutex> lock(_worker->mutex);
+            _worker->path.back() = -_worker->path.back();
+            _worker->frames[_frame].can_split = false;
+            if (!_worker->frames[_frame].stolen)
+                return false;
+            _engine.nr_stolen_frames++;
+            return true;
+        }
+
+    private:
+        ECEngine &_engine;
+        Worker* _worker;
+        int _frame;
+    };
+
+    // Checkpoints
+    //
+    // With -checkpoint=file the path of the search (in the same notation as
+    // the tasks of the workers) is written every opt_checkpoint_interval
+    // seconds, together with the number of solutions and the time so far,
+    // and the size of the output at that moment. All solutions before the path in
+    // the search order have been written. The file is first written under
+    // a temporary name and then renamed, such that it is always complete.
+    // With -resume=file the path is replayed: the ignored vectors are skipped
+    // and the search continues with the selected vectors. For each step of
+    // the path, the column on which was branched is also written, and taken
+    // again when resuming, because the order of the columns with the same
+    // number of vectors depends on the history. (When counting, all the
+    // vectors of one column have to be tried, see CountTable.) The size of
+    // the output is asked from the visitor, which is asked to truncate the
+    // output to it when resuming, such that no solution is repeated.
+    // Checkpoints are only supported for the search with one thread without
+    // the bitset engine.
+
+    std::vector<int> checkpoint_path;
+    std::vector<int> checkpoint_columns;
+    time_t next_checkpoint = 0;
+    std::vector<int> resume_path;
+    std::vector<int> resume_columns;
+    size_t resume_pos = 0;
+    uint64_t checkpoint_fingerprint = 0;
+    double time_before_resume = 0.0; // the time of the runs before the checkpoint
+
+    // Returns a value that identifies the (reduced) matrix at the start of
+    // the search, to check that a checkpoint is resumed with the same input
+    // and options.
+    uint64_t matrix_fingerprint()
+    {
+        uint64_t hash = mix_hash(nr_pos) ^ nr_vec;
+        for (Position position = matrix.r[root]; position != root; position = matrix.r[position])
+            hash = mix_hash(hash ^ pos(position).nr);
+        for (Vector vector = matrix.d[root]; vector != root; vector = matrix.d[vector])
+            hash = mix_hash(hash ^ vec(vector).nr);
+        return hash;
+    }
+
+    void write_checkpoint()
+    {
+        long offset = shared->solution_visitor != 0 ? shared->solution_visitor->output_size() : -1;
+        std::string tmp_filename = std::string(opt_checkpoint) + ".tmp";
+        FILE *f = fopen(tmp_filename.c_str(), "wt");
+        if (f == 0)
+        {
+            fprintf(stderr, "Error: Cannot write checkpoint %s\n", tmp_filename.c_str());
+            return;
+        }
+        fprintf(f, "ExactCover checkpoint\n");
+        fprintf(f, "matrix %llx\n", (unsigned long long)checkpoint_fingerprint);
+        fprintf(f, "solutions %ld\n", nr_solutions);
+        fprintf(f, "calls %ld\n", nr_calls_to_solve);
+        fprintf(f, "time %lf\n", time_before_resume + (clock() - start_time)/1000.0);
+        fprintf(f, "offset %ld\n", offset);
+        fprintf(f, "path %lu\n", (unsigned long)checkpoint_path.size());
+        for (size_t i = 0; i < checkpoint_path.size(); i++)
+            fprintf(f, "%d %d\n", checkpoint_path[i], checkpoint_columns[i]);
+        bool ok = fflush(f) == 0 && fsync(fileno(f)) == 0;
+        ok = fclose(f) == 0 && ok;
+        if (!ok || rename(tmp_filename.c_str(), opt_checkpoint) != 0)
+            fprintf(stderr, "Error: Cannot write checkpoint %s\n", opt_checkpoint);
+        else if (flog != 0)
+            fprintf(flog, "Checkpoint at %ld solutions, depth %d\n", nr_solutions, nr_sol_vectors);
+    }
+
+    // Called at the start of each call of solve(). Only looks at the clock
+    // once in every 4096 calls.
+    inline void checkpoint()
+    {
+        if (opt_checkpoint == 0 || (nr_calls_to_solve & 4095) != 0 || resume_pos < resume_path.size())
+            return;
+        time_t now = time(0);
+        if (now < next_checkpoint)
+            return;
+        write_checkpoint();
+        next_checkpoint = now + opt_checkpoint_interval;
+    }
+
+    // Returns whether the output has been truncated to the checkpoint
+    bool read_checkpoint(const char *filename)
+    {
+        FILE *f = fopen(filename, "rt");
+        if (f == 0)
+        {
+            fprintf(stderr, "Error: Cannot open checkpoint %s\n", filename);
+            exit(1);
+        }
+        unsigned long long fingerprint;
+        long offset;
+        unsigned long path_len;
+        if (   fscanf(f, "ExactCover checkpoint matrix %llx solutions %ld calls %ld time %lf offset %ld path %lu",
+                      &fingerprint, &nr_solutions, &nr_calls_to_solve, &time_before_resume, &offset, &path_len) != 6)
+        {
+            fprintf(stderr, "Error: %s is not a checkpoint\n", filename);
+            exit(1);
+        }
+        resume_path.resize(path_len);
+        resume_columns.resize(path_len);
+        for (unsigned long i = 0; i < path_len; i++)
+            if (   fscanf(f, "%d %d", &resume_path[i], &resume_columns[i]) != 2
+                || resume_path[i] == 0 || abs(resume_path[i]) > matrix.nr_vectors
+                || resume_columns[i] < 0 || resume_columns[i] >= matrix.nr_positions)
+            {
+                fprintf(stderr, "Error: Checkpoint %s is truncated\n", filename);
+                exit(1);
+            }
+        fclose(f);
+
+        if (fingerprint != checkpoint_fingerprint)
+        {
+            fprintf(stderr, "Error: Checkpoint %s was made for another input or with other options\n", filename);
+            exit(1);
+        }
+
+        if (offset < 0 || shared->solution_visitor == 0 || !shared->solution_visitor->truncate_output(offset))
+        {
+            fprintf(stderr, "Warning: The output is not truncated; solutions after the checkpoint may be repeated\n");
+            offset = -1;
+        }
+        if (flog != 0) fprintf(flog, "Resuming at %ld solutions, depth %lu\n", nr_solutions, path_len);
+        return offset >= 0;
+    }
+
+    // Keeps the frames of solve() on checkpoint_path
+    class CheckpointFrame
+    {
+    public:
+        CheckpointFrame(ECEngine &engine) : _engine(engine), _start(engine.checkpoint_path.size()) {}
+        ~CheckpointFrame()
+        {
+            if (_engine.opt_checkpoint != 0)
+            {
+                _engine.checkpoint_path.resize(_start);
+                _engine.checkpoint_columns.resize(_start);
+            }
+        }
+        void select(Vector vector, Position position)
+        {
+            if (_engine.opt_checkpoint != 0)
+            {
+                _engine.checkpoint_path.push_back(_engine.vec(vector).nr);
+                _engine.checkpoint_columns.push_back(_engine.pos(position).nr);
+            }
+        }
+        void unselect() { if (_engine.opt_checkpoint != 0) _engine.checkpoint_path.back() = -_engine.checkpoint_path.back(); }
+
+    private:
+        ECEngine &_engine;
+        size_t _start;
+    };
+
+    // When resuming, returns the next element of the path together with its
+    // column, or 0 when the end of the path has been reached.
+    inline int resume_step(Position &column)
+    {
+        if (resume_pos == resume_path.size())
+            return 0;
+        column = position_with_nr(resume_columns[resume_pos]);
+        if (!is_uncovered(column))
+        {
+            fprintf(stderr, "Error: The checkpoint does not match the search\n");
+            exit(1);
+        }
+        return resume_path[resume_pos++];
+    }
+
+    // Progress
+    //
+    // With -estimate=N the size of the search is estimated with N probes
+    // before the search starts. During the search, the number of nodes that
+    // have been visited is compared with this estimate every PROGRESS_INTERVAL
+    // seconds, to estimate the remaining time.
+
+#define PROGRESS_INTERVAL 10
+
+    // Called at the start of each call of solve(). Only every 4096 calls the
+    // nodes are added to the total and the clock is looked at.
+    inline void progress()
+    {
+        if (shared->estimated_nodes == 0.0 || (nr_calls_to_solve & 4095) != 0)
+            return;
+        long nodes = shared->nr_nodes_visited += 4096;
+        time_t now = time(0);
+        time_t next = shared->next_progress;
+        if (now < next || !shared->next_progress.compare_exchange_strong(next, now + PROGRESS_INTERVAL))
+            return;
+        double elapsed = difftime(now, shared->search_start_time);
+        double left = shared->estimated_nodes - shared->nr_nodes_before_search - nodes;
+        if (flog == 0)
+            return;
+        if (left <= 0.0)
+            fprintf(flog, "progress: %ld nodes, more than the estimate\n", shared->nr_nodes_before_search + nodes);
+        else
+            fprintf(flog, "progress: %ld of about %.3g nodes (%.1lf%%), about %.0lf seconds left\n",
+                    shared->nr_nodes_before_search + nodes, shared->estimated_nodes,
+                    100.0 * (shared->nr_nodes_before_search + nodes) / shared->estimated_nodes, elapsed * left / nodes);
+    }
+
+    Position select_best_position(int &best_nr)
+    {
+        if (opt_branch == BRANCH_MRV)
+        {
+            // Finding the first non-empty bucket takes at most as many steps
+            // as the number of branches that will be tried for the column
+            for (int key = 1; key <= matrix.nr_vectors + 1; key++)
+                if (matrix.bucket_start[key] < matrix.bucket_start[key + 1])
+                {
+                    best_nr = key - 1;
+                    return matrix.sorted[matrix.bucket_start[key]];
+                }
+            best_nr = 0;
+            return root;
+        }
+        
+        Position best_pos = 0;
+        best_nr = 0;
+        for (Position position = matrix.r[root]; position != root; position = matrix.r[position])
+        {
+            if (pos(position).nr_vec_left == 1)
+            {
+                best_nr = 1;
+                return position;
+            }
+            
+            if (best_pos == 0 || pos(position).nr_vec_left > best_nr)
+            {
+                best_pos = position;
+                best_nr = pos(position).nr_vec_left;
+            }
+        }
+        return best_pos;
+    }
+
+
+    // Returns true when the visitor stops the search
+    bool output_solution()
+    {
+        if (!symmetry_canonical())
+            return false;
+        if (component_solutions != 0)
+        {
+            component_solutions->push_back(std::vector<Vector>(sol_vectors.begin() + component_depth, sol_vectors.begin() + nr_sol_vectors));
+            return false;
+        }
+        long weight = path_weight();
+        nr_solutions += weight;
+        if (opt_profile)
+            depth_stats(nr_sol_vectors).solutions += weight;
+        if (opt_count || shared->solution_visitor == 0)
+            return false;
+        
+        // The solution is passed for each choice of aliases
+        if (nr_duplicate_vectors > 0)
+            alias_choice.assign(nr_sol_vectors, 0);
+        bool stop = false;
+        do
+            stop = pass_solution();
+        while (!stop && next_alias_choice());
+        if (stop)
+            shared->search_stopped = true;
+        return stop;
+    }
+
+    bool pass_solution()
+    {
+        solution_rows.resize(nr_sol_vectors);
+        for (int i = 0; i < nr_sol_vectors; i++)
+            solution_rows[i] = solution_row(i);
+        
+        if (cur_worker != 0)
+        {
+            std::lock_guard<std::mutex> lock(shared->solution_visitor_mutex);
+            return shared->search_stopped || shared->solution_visitor->solution(solution_rows.data(), nr_sol_vectors);
+        }
+        
+        bool stop = shared->solution_visitor->solution(solution_rows.data(), nr_sol_vectors);
+        
+        clock_t now = clock();
+        if (now > start_periode + 1000)
+        {
+            if (flog != 0)
+            {
+                fprintf(flog, "%4ld: ", (start_periode - start_time)/1000);
+                for (; sol_found_in_periode > 0; sol_found_in_periode--)
+                    fprintf(flog, "*");
+                fprintf(flog, "  %lf\n", nr_solutions / ((now - start_time)/1000.0));
+            }
+            start_periode += 1000;
+        }
+        while (now > start_periode + 1000)
+        {
+            if (flog != 0) fprintf(flog, "%4ld: \n", (start_periode - start_time)/1000);
+            start_periode += 1000;
+        }
+        
+        sol_found_in_periode++;
+        return stop;
+    }
+
+    // Propagation
+    //
+    // With -propagate=N, each node of solve() first removes the vectors that
+    // conflict with all vectors of some column with two up to N+1 vectors,
+    // because these vectors cannot be part of a solution. This is repeated as
+    // long as vectors are removed, until about PROPAGATE_BUDGET nodes have
+    // been visited. Nothing is done when a column has one vector, because
+    // solve() selects that vector next. With the MRV heuristic, the columns
+    // are taken from the buckets, which are kept up to date incrementally.
+    //
+    // The removed vectors are not part of a solution of any subproblem below
+    // the node, so the counts of the subproblems can still be memoized.
+
+#define PROPAGATE_BUDGET 4096
+
+    long nr_propagated = 0;
+    std::vector<uint32_t> propagate_marks;
+    uint32_t propagate_mark = 0;
+    std::vector<Position> propagate_columns;
+    std::vector<Vector> propagate_vectors;
+
+    // Collects the columns with two up to N+1 vectors. Returns false when
+    // there is a column with less than two vectors.
+    bool find_propagate_columns()
+    {
+        propagate_columns.clear();
+        if (use_buckets())
+        {
+            if (matrix.bucket_start[1] < matrix.bucket_start[3])
+                return false;
+            for (int key = 3; key <= opt_propagate + 2 && key <= matrix.nr_vectors + 1; key++)
+                for (int i = matrix.bucket_start[key]; i < matrix.bucket_start[key + 1]; i++)
+                    propagate_columns.push_back(matrix.sorted[i]);
+            return true;
+        }
+        for (Position position = matrix.r[root]; position != root; position = matrix.r[position])
+        {
+            int nr = pos(position).nr_vec_left;
+            if (nr < 2)
+                return false;
+            if (nr <= opt_propagate + 1)
+                propagate_columns.push_back(position);
+        }
+        return true;
+    }
+
+    // Collects in propagate_vectors the vectors that conflict with all
+    // vectors of the column, and returns the number of visited nodes. Each
+    // vector gets a mark, which is increased for each vector of the column
+    // that it conflicts with.
+    long find_conflicting_vectors(Position position)
+    {
+        propagate_vectors.clear();
+        int nr = pos(position).nr_vec_left;
+        if (propagate_marks.size() < (size_t)matrix.nr_vectors || propagate_mark > UINT32_MAX - nr - 2)
+        {
+            propagate_marks.assign(matrix.nr_vectors, 0);
+            propagate_mark = 0;
+        }
+        uint32_t base = propagate_mark;
+        propagate_mark += nr + 1;
+        
+        // The vectors of the column itself are excluded
+        for (Node node = matrix.d[position]; node != position; node = matrix.d[node])
+            propagate_marks[vec(matrix.vector[node]).nr - 1] = base + nr + 1;
+        
+        long nr_visited = 0;
+        int i = 1;
+        for (Node node = matrix.d[position]; node != position; node = matrix.d[node], i++)
+        {
+            Vector vector = matrix.vector[node];
+            long nr_marked = 0;
+            for (Node node2 = matrix.r[vector]; node2 != vector; node2 = matrix.r[node2])
+            {
+                Position position2 = matrix.position[node2];
+                if (position2 == position)
+                    continue;
+                for (Node node3 = matrix.d[position2]; node3 != position2; node3 = matrix.d[node3])
+                {
+                    uint32_t &mark = propagate_marks[vec(matrix.vector[node3]).nr - 1];
+                    if (i == 1 ? mark <= base : mark == base + i - 1)
+                    {
+                        mark = base + i;
+                        nr_marked++;
+                        if (i == nr)
+                            propagate_vectors.push_back(matrix.vector[node3]);
+                    }
+                }
+                nr_visited += pos(position2).nr_vec_left;
+            }
+            if (nr_marked == 0)
+                break;
+        }
+        return nr_visited;
+    }
+
+    void propagate(IgnoredNodes &ignoredNodes)
+    {
+        long budget = PROPAGATE_BUDGET;
+        for (bool removed = true; removed && budget > 0;)
+        {
+            removed = false;
+            if (!find_propagate_columns())
+                return;
+            for (size_t c = 0; c < propagate_columns.size() && budget > 0; c++)
+            {
+                Position position = propagate_columns[c];
+                if (pos(position).nr_vec_left < 2)
+                    return;
+                budget -= find_conflicting_vectors(position);
+                for (size_t i = 0; i < propagate_vectors.size(); i++)
+                {
+                    ignoredNodes.add(propagate_vectors[i]);
+                    nr_propagated++;
+                    if (opt_profile)
+                        depth_stats(nr_sol_vectors).propagated++;
+                    removed = true;
+                }
+            }
+        }
+    }
+
+    // Independent components
+    //
+    // With -components, each node of solve() first checks whether the
+    // uncovered columns fall apart in components, such that no vector has
+    // columns in two of them. Each component is then solved on its own, with
+    // the columns of the other components hidden. When counting, the number
+    // of solutions is the product of the numbers of the components, and each
+    // component is memoized by itself. Otherwise, the solutions of each
+    // component are collected in component_solutions (holding the vectors
+    // selected after component_depth) and their combinations are written.
+
+    long nr_component_splits = 0;
+    std::vector<int> component_of;
+    std::vector<uint32_t> component_marks;
+    uint32_t component_mark = 0;
+    std::vector<Position> component_queue;
+
+    // Returns the number of components of the uncovered columns, and fills
+    // component_of for each of these columns. Each vector is visited once.
+    int find_components()
+    {
+        if (component_of.size() < (size_t)matrix.nr_positions)
+            component_of.assign(matrix.nr_positions, -1);
+        if (component_marks.size() < (size_t)matrix.nr_vectors || component_mark == UINT32_MAX)
+        {
+            component_marks.assign(matrix.nr_vectors, 0);
+            component_mark = 0;
+        }
+        component_mark++;
+        for (Position position = matrix.r[root]; position != root; position = matrix.r[position])
+            component_of[position - 1] = -1;
+        
+        int nr = 0;
+        for (Position start = matrix.r[root]; start != root; start = matrix.r[start])
+        {
+            if (component_of[start - 1] >= 0)
+                continue;
+            component_of[start - 1] = nr;
+            component_queue.clear();
+            component_queue.push_back(start);
+            for (size_t i = 0; i < component_queue.size(); i++)
+            {
+                Position position = component_queue[i];
+                for (Node node = matrix.d[position]; node != position; node = matrix.d[node])
+                {
+                    Vector vector = matrix.vector[node];
+                    uint32_t &mark = component_marks[vec(vector).nr - 1];
+                    if (mark == component_mark)
+                        continue;
+                    mark = component_mark;
+                    for (Node node2 = matrix.r[vector]; node2 != vector; node2 = matrix.r[node2])
+                    {
+                        Position position2 = matrix.position[node2];
+                        if (component_of[position2 - 1] != nr)
+                        {
+                            component_of[position2 - 1] = nr;
+                            component_queue.push_back(position2);
+                        }
+                    }
+                }
+            }
+            nr++;
+        }
+        return nr;
+    }
+
+
+    // Solves the given component, with the columns of the others hidden. The
+    // nodes of a hidden column are left in the rows of its vectors, because
+    // the search of the component does not visit these vectors.
+    bool solve_component(const std::vector<std::vector<Position> > &components, size_t c)
+    {
+        for (size_t c2 = 0; c2 < components.size(); c2++)
+            if (c2 != c)
+                for (size_t i = 0; i < components[c2].size(); i++)
+                {
+                    Position position = components[c2][i];
+                    swapout_horz(position);
+                    toggle_uncovered(position);
+                    if (use_buckets())
+                        bucket_cover(position);
+                }
+        
+        bool result = solve();
+        
+        for (size_t c2 = components.size(); c2-- > 0;)
+            if (c2 != c)
+                for (size_t i = components[c2].size(); i-- > 0;)
+                {
+                    Position position = components[c2][i];
+                    swapin_horz(position);
+                    toggle_uncovered(position);
+                    if (use_buckets())
+                        bucket_uncover(position);
+                }
+        return result;
+    }
+
+    bool output_component_solutions(const std::vector<ComponentSolutions> &solutions, size_t c)
+    {
+        if (c == solutions.size())
+            return output_solution();
+        for (size_t i = 0; i < solutions[c].size(); i++)
+        {
+            const std::vector<Vector> &solution = solutions[c][i];
+            for (size_t j = 0; j < solution.size(); j++)
+                sol_vectors[nr_sol_vectors++] = solution[j];
+            bool result = output_component_solutions(solutions, c + 1);
+            nr_sol_vectors -= solution.size();
+            if (result)
+                return true;
+        }
+        return false;
+    }
+
+    static bool fewer_columns(const std::vector<Position> &a, const std::vector<Position> &b) { return a.size() < b.size(); }
+
+    bool solve_components(int nr)
+    {
+        nr_component_splits++;
+        std::vector<std::vector<Position> > components(nr);
+        for (Position position = matrix.r[root]; position != root; position = matrix.r[position])
+            components[component_of[position - 1]].push_back(position);
+        // Small components are solved first, as they are cheap to find without
+        // solutions, in which case the others are not solved
+        std::stable_sort(components.begin(), components.end(), fewer_columns);
+        
+        if (opt_count)
+        {
+            long weight = path_weight();
+            long product = 1;
+            for (size_t c = 0; c < components.size() && product > 0; c++)
+            {
+                long nr_solutions_before = nr_solutions;
+                if (solve_component(components, c))
+                    return true;
+                product *= (nr_solutions - nr_solutions_before) / weight;
+                nr_solutions = nr_solutions_before;
+            }
+            nr_solutions += product * weight;
+            return false;
+        }
+        
+        std::vector<ComponentSolutions> solutions(nr);
+        ComponentSolutions *outer_solutions = component_solutions;
+        int outer_depth = component_depth;
+        component_depth = nr_sol_vectors;
+        bool result = false;
+        for (size_t c = 0; c < components.size(); c++)
+        {
+            component_solutions = &solutions[c];
+            result = solve_component(components, c);
+            if (result || solutions[c].empty())
+                break;
+        }
+        component_solutions = outer_solutions;
+        component_depth = outer_depth;
+        if (!result && !solutions.back().empty())
+            result = output_component_solutions(solutions, 0);
+        return result;
+    }
+
+
+    // Solves the node as independent components, when it falls apart
+    bool solve_node()
+    {
+        // A column without vectors is left to solve_branches(), because the
+        // hidden columns are not counted in nr_pos_with_zero_vec
+        if (opt_components && nr_pos_with_zero_vec == 0)
+        {
+            int nr = find_components();
+            if (nr > 1)
+                return solve_components(nr);
+        }
+        return solve_branches();
+    }
+
+    bool solve()
+    {
+        nr_calls_to_solve++;
+        checkpoint();
+        progress();
+        ProfiledNode profiledNode(*this, nr_sol_vectors);
+        
+        // Another thread may have stopped the search
+        if (cur_worker != 0 && shared->search_stopped)
+            return true;
+        
+        // Found solution if there are no positions left
+        if (matrix.r[root] == root)
+            return output_solution(); // true: stop searching
+        
+        // A subproblem on the path that is resumed, is only partially solved
+        if (count_table == 0 || !may_memoize() || resume_pos < resume_path.size())
+            return solve_node();
+        
+        long weight = path_weight();
+        long count;
+        if (count_table->lookup(matrix.uncovered, matrix.uncovered_hash, count))
+        {
+            nr_solutions += count * weight;
+            return false;
+        }
+        long nr_solutions_before = nr_solutions;
+        long nr_stolen_frames_before = nr_stolen_frames;
+        
+        bool result = solve_node();
+        
+        if (!result && nr_stolen_frames == nr_stolen_frames_before)
+            count_table->store(matrix.uncovered, matrix.uncovered_hash, (nr_solutions - nr_solutions_before) / weight);
+        return result;
+    }
+
+    // Branches on the vectors of the best column
+    bool solve_branches()
+    {
+        if (flog != 0 && tracePrint())
+        {
+            fprintf(flog, "working on:\n");
+            for (int i = 0; i < nr_sol_vectors; i++)
+                fprintf(flog, "  %s\n", vec(sol_vectors[i]).name);
+        }
+            
+        IgnoredNodes ignoredNodes(*this);
+        PublishedFrame publishedFrame(*this);
+        CheckpointFrame checkpointFrame(*this);
+        Position fixed_pos = 0;
+        for (bool first = true;; first = false)
+        {
+            if (opt_propagate > 0)
+                propagate(ignoredNodes);
+            
+            // If there is a position that cannot be filled, then stop
+            if (nr_pos_with_zero_vec > 0)
+            {
+                //printf("%*.*simpossible\n", nr_sol_vectors, nr_sol_vectors, "");
+                if (first && opt_profile)
+                    depth_stats(nr_sol_vectors).dead_ends++;
+                return false;
+            }
+            
+            // When resuming, the vectors and columns on the path of the
+            // checkpoint are taken
+            Position resume_column = 0;
+            int resume_nr = resume_step(resume_column);
+            
+            int best_nr;
+            Position best_pos;
+            if (resume_column != 0)
+            {
+                best_pos = resume_column;
+                best_nr = pos(best_pos).nr_vec_left;
+            }
+            else if (fixed_pos != 0)
+            {
+                best_pos = fixed_pos;
+                best_nr = pos(best_pos).nr_vec_left;
+            }
+            else
+                best_pos = select_best_position(best_nr);
+            // When counting, all vectors of the column are tried (see
+            // CountTable)
+            if (count_table != 0)
+                fixed_pos = best_pos;
+
+#if 0 // use reduction while solving
+            int nr_hot = 0;
+            int nr_impos = 0;
+            int nr_pass = 0;
+        
+            for (bool changes = true; changes; )
+            {
+                nr_pass++;
+                changes = false;
+                
+                for (Vector vector = matrix.d[root]; vector != root; vector = matrix.d[vector])
+                {
+                    if (vec(vector).hot)
+                    {
+                        nr_hot++;
+                        selectVector(vector);
+                        
+                        // Evaluate solution
+                        bool pos = possible(1);
+        
+                        unselectVector(vector);
+                        
+                        if (!pos)
+                        {
+                            nr_impos++;
+                            if (flog != 0) fprintf(flog, "%*.*sremoved impossible %s\n", nr_sol_vectors, nr_sol_vectors, "", vec(vector).name);
+                            ignoredNodes.add(vector);
+                            changes = true;
+                            vec(vector).hot = false;
+                        }
+                        vec(vector).hot = false;
+                    }
+                }
+            }
+            //printf("%*.*s%d:%d %d\n", nr_sol_vectors, nr_sol_vectors, "", nr_hot, nr_impos, nr_pass);
+#endif    
+
+
+            //printf("%*.*sbest = %d\n", nr_sol_vectors, nr_sol_vectors, "", best_nr);
+
+            if (best_nr == 0)
+            {
+                fprintf(stderr, "ERROR\n");
+                return false;
+            }
+                
+#if 0        
+            if (best_nr > 500)
+            {
+                // Select the vector whoes positions have the lowest number of vectors
+                best_vec = 0;
+                best_nr = 0;
+                for (Node node_of_best = matrix.d[best_pos]; node_of_best != best_pos; node_of_best = matrix.d[node_of_best])
+                {
+                    Vector vector = matrix.vector[node_of_best];
+                
+                    int nr = 0;
+                    for (Node node = matrix.r[vector]; node != vector; node = matrix.r[node])
+                        nr += pos(matrix.position[node]).nr_vec_left;
+                    
+                    if (best_vec == 0 || nr < best_nr)
+                    {
+                        best_vec = vector;
+                        best_nr = nr;
+                    }
+                }
+            }
+#endif
+            
+            if (resume_nr < 0)
+            {
+                // Explored before the checkpoint
+                Vector vector = vector_with_nr(-resume_nr);
+                checkpointFrame.select(vector, best_pos);
+                checkpointFrame.unselect();
+                ignoredNodes.add(vector);
+                continue;
+            }
+            Vector sel_vector = resume_nr > 0 ? vector_with_nr(resume_nr) : matrix.vector[matrix.d[best_pos]];
+            long covers_before = nr_covers;
+            sol_vectors[nr_sol_vectors++] = sel_vector;
+            selectVector(sel_vector);
+            publishedFrame.select(sel_vector, best_nr > 1);
+            checkpointFrame.select(sel_vector, best_pos);
+            if (opt_profile)
+            {
+                depth_stats(nr_sol_vectors - 1).branches++;
+                depth_stats(nr_sol_vectors - 1).covers += nr_covers - covers_before;
+            }
+        
+            bool result = false;
+            if (symmetry_select(sel_vector))
+                result = solve();
+            symmetry_unselect(sel_vector);
+        
+            long uncovers_before = nr_uncovers;
+            unselectVector(sel_vector);
+            nr_sol_vectors--;
+            if (opt_profile)
+                depth_stats(nr_sol_vectors).uncovers += nr_uncovers - uncovers_before;
+            
+            if (result)
+                return true;
+            
+            if (publishedFrame.unselect())
+                return false;
+            checkpointFrame.unselect();
+
+            if (best_nr == 1 && resume_nr == 0)
+                return false;
+                
+            ignoredNodes.add(sel_vector);
+
+        }        
+        
+        return false;
+    }
+
+    // Bitset engine
+    //
+    // When the number of (remaining) columns fits in 64 or 128 bits, each
+    // vector is represented by a mask. Each level of the search has its own
+    // list of the vectors that are still possible, together with the number
+    // of vectors for each column. Selecting a vector is done by filtering
+    // the vectors that do not overlap with it into the list of the next
+    // level. The choices are made with the same heuristic as in solve(). With
+    // -branch=max the same solutions are found in the same order.
+
+    static inline void add_counts(int *counts, uint64_t mask)
+    {
+        for (; mask != 0; mask &= mask - 1)
+            counts[__builtin_ctzll(mask)]++;
+    }
+
+    static inline void sub_counts(int *counts, uint64_t mask)
+    {
+        for (; mask != 0; mask &= mask - 1)
+            counts[__builtin_ctzll(mask)]--;
+    }
+
+    static inline void add_counts(int *counts, __uint128_t mask)
+    {
+        add_counts(counts, (uint64_t)mask);
+        add_counts(counts + 64, (uint64_t)(mask >> 64));
+    }
+
+    static inline void sub_counts(int *counts, __uint128_t mask)
+    {
+        sub_counts(counts, (uint64_t)mask);
+        sub_counts(counts + 64, (uint64_t)(mask >> 64));
+    }
+
+    static inline int lowest_bit(uint64_t mask) { return __builtin_ctzll(mask); }
+
+    static inline int lowest_bit(__uint128_t mask)
+    {
+        return (uint64_t)mask != 0 ? __builtin_ctzll((uint64_t)mask) : 64 + __builtin_ctzll((uint64_t)(mask >> 64));
+    }
+
+    static inline int popcount(uint64_t mask) { return __builtin_popcountll(mask); }
+
+    static inline int popcount(__uint128_t mask) { return __builtin_popcountll((uint64_t)mask) + __builtin_popcountll((uint64_t)(mask >> 64)); }
+
+    static inline void mask_to_key(uint64_t mask, uint64_t *key) { key[0] = mask; }
+
+    static inline void mask_to_key(__uint128_t mask, uint64_t *key)
+    {
+        key[0] = (uint64_t)mask;
+        key[1] = (uint64_t)(mask >> 64);
+    }
+
+    template <class Mask>
+    class BitsetSolver
+    {
+    public:
+        BitsetSolver(ECEngine &engine) : _engine(engine)
+        {
+            _nr_pos = 0;
+            for (Position position = _engine.matrix.r[root]; position != root; position = _engine.matrix.r[position])
+                _engine.pos(position).hotpos = _nr_pos++;
+            
+            _levels.resize(_nr_pos + 1);
+            Level &level = _levels[0];
+            level.reserve(_engine.nr_vec);
+            for (int c = 0; c < _nr_pos; c++)
+                level.counts[c] = 0;
+            for (Vector vector = _engine.matrix.d[root]; vector != root; vector = _engine.matrix.d[vector])
+            {
+                Mask mask = 0;
+                for (Node node = _engine.matrix.r[vector]; node != vector; node = _engine.matrix.r[node])
+                    mask |= (Mask)1 << _engine.pos(_engine.matrix.position[node]).hotpos;
+                level.masks[level.n] = mask;
+                level.vectors[level.n] = vector;
+                level.n++;
+                add_counts(level.counts, mask);
+            }
+            
+            _all = 0;
+            for (int c = 0; c < _nr_pos; c++)
+                _all |= (Mask)1 << c;
+        }
+        
+        void solve() { solve(0, _all); }
+
+    private:
+        ECEngine &_engine;
+        struct Level
+        {
+            Level() : n(0), capacity(0), masks(0), vectors(0) {}
+            ~Level() { delete[] masks; delete[] vectors; }
+            void reserve(size_t size)
+            {
+                if (size <= capacity)
+                    return;
+                delete[] masks;
+                delete[] vectors;
+                masks = new Mask[size];
+                vectors = new Vector[size];
+                capacity = size;
+            }
+            size_t n;
+            size_t capacity;
+            Mask *masks;
+            Vector *vectors;
+            int counts[128];
+        };
+        int _nr_pos;
+        Mask _all;
+        std::vector<Level> _levels;
+        
+        void filter(Level &from, Mask sel_mask, Level &to)
+        {
+            to.reserve(from.n);
+            for (int c = 0; c < _nr_pos; c++)
+                to.counts[c] = 0;
+            
+            size_t j = 0;
+            for (size_t i = 0; i < from.n; i++)
+                if ((from.masks[i] & sel_mask) == 0)
+                {
+                    to.masks[j] = from.masks[i];
+                    to.vectors[j] = from.vectors[i];
+                    add_counts(to.counts, from.masks[i]);
+                    j++;
+                }
+            to.n = j;
+        }
+        
+        // Returns a best_nr of zero, if some column has no vectors left
+        void select_best_column(Level &level, Mask uncovered, int &best_pos, int &best_nr)
+        {
+            for (Mask columns = uncovered; columns != 0; columns &= columns - 1)
+            {
+                int c = lowest_bit(columns);
+                int nr_vec_left = level.counts[c];
+                if (nr_vec_left == 0)
+                {
+                    best_nr = 0;
+                    return;
+                }
+                if (_engine.opt_branch == BRANCH_MRV)
+                {
+                    if (best_pos == -1 || nr_vec_left < best_nr)
+                    {
+                        best_pos = c;
+                        best_nr = nr_vec_left;
+                    }
+                    continue;
+                }
+                if (best_nr == 1)
+                    continue;
+                if (nr_vec_left == 1 || nr_vec_left > best_nr)
+                {
+                    best_pos = c;
+                    best_nr = nr_vec_left;
+                }
+            }
+        }
+        
+        bool solve(int depth, Mask uncovered)
+        {
+            _engine.nr_calls_to_solve++;
+            _engine.progress();
+            ProfiledNode profiledNode(_engine, depth);
+            
+            if (uncovered == 0)
+                return _engine.output_solution();
+            
+            if (_engine.count_table == 0)
+                return solve_branches(depth, uncovered);
+            
+            const int nr_words = sizeof(Mask) / sizeof(uint64_t);
+            uint64_t key[nr_words];
+            mask_to_key(uncovered, key);
+            uint64_t hash = 0;
+            for (int i = 0; i < nr_words; i++)
+                hash = mix_hash(hash ^ key[i]);
+            
+            long weight = _engine.path_weight();
+            long count;
+            if (_engine.count_table->lookup(key, hash, count))
+            {
+                _engine.nr_solutions += count * weight;
+                return false;
+            }
+            long nr_solutions_before = _engine.nr_solutions;
+            
+            bool result = solve_branches(depth, uncovered);
+            
+            if (!result)
+                _engine.count_table->store(key, hash, (_engine.nr_solutions - nr_solutions_before) / weight);
+            return result;
+        }
+        
+        bool solve_branches(int depth, Mask uncovered)
+        {
+            Level &level = _levels[depth];
+            int fixed_pos = -1;
+            for (bool first = true;; first = false)
+            {
+                int best_pos = fixed_pos;
+                int best_nr = 0;
+                if (best_pos != -1)
+                    best_nr = level.counts[best_pos];
+                else
+                    select_best_column(level, uncovered, best_pos, best_nr);
+                if (best_nr == 0)
+                {
+                    if (first && _engine.opt_profile)
+                        _engine.depth_stats(depth).dead_ends++;
+                    return false;
+                }
+                // When counting, all vectors of the column are tried (see
+                // CountTable)
+                if (_engine.count_table != 0)
+                    fixed_pos = best_pos;
+                
+                Mask best_mask = (Mask)1 << best_pos;
+                size_t sel = 0;
+                while ((level.masks[sel] & best_mask) == 0)
+                    sel++;
+                Mask sel_mask = level.masks[sel];
+                
+                filter(level, sel_mask, _levels[depth + 1]);
+                _engine.sol_vectors[_engine.nr_sol_vectors++] = level.vectors[sel];
+                if (_engine.opt_profile)
+                {
+                    int nr_columns = popcount(sel_mask);
+                    _engine.depth_stats(depth).branches++;
+                    _engine.depth_stats(depth).covers += nr_columns;
+                    _engine.depth_stats(depth).uncovers += nr_columns;
+                }
+                
+                bool result = false;
+                if (_engine.symmetry_select(level.vectors[sel]))
+                    result = solve(depth + 1, uncovered & ~sel_mask);
+                _engine.symmetry_unselect(level.vectors[sel]);
+                
+                _engine.nr_sol_vectors--;
+                
+                if (result)
+                    return true;
+                
+                if (best_nr == 1)
+                    return false;
+                
+                // Ignore the selected vector, keeping the order of the others
+                sub_counts(level.counts, sel_mask);
+                level.n--;
+                memmove(level.masks + sel, level.masks + sel + 1, (level.n - sel) * sizeof(Mask));
+                memmove(level.vectors + sel, level.vectors + sel + 1, (level.n - sel) * sizeof(Vector));
+            }
+        }
+    };
+
+    // Copies the matrix (including the state of the links) of another thread
+    void copy_matrix(const Matrix &from)
+    {
+        matrix = from;
+        allocate_matrix(matrix);
+        memcpy(matrix.block, from.block, from.block_size);
+        sol_vectors.resize(matrix.nr_positions);
+    }
+
+    // Selects and ignores the vectors of a path
+    void replay_path(const std::vector<int> &path)
+    {
+        for (size_t i = 0; i < path.size(); i++)
+            if (path[i] > 0)
+            {
+                Vector vector = vector_with_nr(path[i]);
+                sol_vectors[nr_sol_vectors++] = vector;
+                selectVector(vector);
+                symmetry_select(vector);
+            }
+            else
+            {
+                ignoreVector(vector_with_nr(-path[i]), root);
+                nr_vec--;
+            }
+    }
+
+    void unwind_path(const std::vector<int> &path)
+    {
+        for (size_t i = path.size(); i-- > 0;)
+            if (path[i] > 0)
+            {
+                symmetry_unselect(vector_with_nr(path[i]));
+                unselectVector(vector_with_nr(path[i]));
+                nr_sol_vectors--;
+            }
+            else
+            {
+                unignoreVector(vector_with_nr(-path[i]), root);
+                nr_vec++;
+            }
+    }
+
+    void solve_task(const std::vector<int> &task)
+    {
+        replay_path(task);
+        
+        task_ignored.clear();
+        for (size_t i = 0; i < task.size(); i++)
+            if (task[i] < 0 && !has_covered_position(vector_with_nr(-task[i])))
+                task_ignored.push_back(vector_with_nr(-task[i]));
+        
+        solve();
+        
+        unwind_path(task);
+    }
+
+    // The loop of a thread of the search, which runs on an engine of its own
+    static void run_worker(ECEngine *main, int nr)
+    {
+        ECEngine engine(*main, main->shared->workers[nr]);
+        engine.solve_worker(nr);
+    }
+
+    void solve_worker(int nr)
+    {
+        if (opt_count && opt_count_table > 0)
+            count_table = new CountTable(nr_uncovered_words(matrix.nr_positions), opt_count_table / opt_threads);
+        
+        std::vector<int> task;
+        bool have_task = false;
+        while (!shared->search_stopped)
+        {
+            if (!have_task)
+            {
+                shared->nr_active_workers++;
+                size_t t = shared->next_start_task++;
+                have_task = t < shared->start_tasks.size();
+                if (have_task)
+                    task = shared->start_tasks[t];
+                else
+                    shared->nr_active_workers--;
+            }
+            
+            if (have_task)
+            {
+                cur_worker->nr_tasks++;
+                cur_worker->mutex.lock();
+                cur_worker->path = task;
+                cur_worker->mutex.unlock();
+                
+                solve_task(task);
+                
+                shared->nr_active_workers--;
+                have_task = false;
+            }
+            
+            for (int i = 1; i < opt_threads && !have_task; i++)
+            {
+                int victim = (nr + i) % opt_threads;
+                // Increment first, such that the number of active workers
+                // does not drop to zero while the task is being handed over
+                shared->nr_active_workers++;
+                have_task = shared->workers[victim]->steal(task);
+                if (!have_task)
+                    shared->nr_active_workers--;
+            }
+            
+            if (!have_task)
+            {
+                if (shared->nr_active_workers == 0 && shared->next_start_task >= shared->start_tasks.size())
+                    break;
+                std::this_thread::yield();
+            }
+        }
+        
+        cur_worker->nr_solutions = nr_solutions;
+        cur_worker->nr_calls_to_solve = nr_calls_to_solve;
+        cur_worker->nr_propagated = nr_propagated;
+        cur_worker->depth_profile = depth_profile;
+        if (count_table != 0)
+        {
+            cur_worker->nr_count_hits = count_table->nr_hits;
+            cur_worker->nr_count_misses = count_table->nr_misses;
+            delete count_table;
+        }
+    }
+
+    void solve_with_threads()
+    {
+        for (size_t i = 0; i < shared->workers.size(); i++)
+            delete shared->workers[i];
+        shared->workers.clear();
+        for (int i = 0; i < opt_threads; i++)
+            shared->workers.push_back(new Worker());
+        shared->nr_active_workers = 0;
+        
+        std::vector<std::thread> threads;
+        for (int i = 0; i < opt_threads; i++)
+            threads.push_back(std::thread(run_worker, this, i));
+        for (int i = 0; i < opt_threads; i++)
+            threads[i].join();
+        
+        for (int i = 0; i < opt_threads; i++)
+        {
+            Worker* worker = shared->workers[i];
+            if (flog != 0) fprintf(flog, "worker %d: %ld nodes, %ld solutions, %ld tasks\n", i, worker->nr_calls_to_solve, worker->nr_solutions, worker->nr_tasks);
+            nr_solutions += worker->nr_solutions;
+            nr_calls_to_solve += worker->nr_calls_to_solve;
+            nr_propagated += worker->nr_propagated;
+            nr_count_hits += worker->nr_count_hits;
+            nr_count_misses += worker->nr_count_misses;
+            for (size_t d = 0; d < worker->depth_profile.size(); d++)
+            {
+                DepthProfile &from = worker->depth_profile[d];
+                DepthProfile &to = depth_stats(d);
+                to.nodes += from.nodes;
+                to.branches += from.branches;
+                to.dead_ends += from.dead_ends;
+                to.propagated += from.propagated;
+                to.solutions += from.solutions;
+                to.covers += from.covers;
+                to.uncovers += from.uncovers;
+                to.seconds += from.seconds;
+            }
+        }
+    }
+
+    // Estimating the size of the search
+    //
+    // Knuth's estimate of the number of nodes below the current node of the
+    // search: follow a random path down, where at each level the product of
+    // the number of branches taken so far estimates the number of nodes at
+    // that level (and the number of solutions, when the path ends with a
+    // solution). The average of several of these paths is taken. The random
+    // numbers are derived from the seed with mix_hash, such that the estimates
+    // are the same on all machines.
+
+    double estimate_nodes(uint64_t seed, int nr_probes, double &solutions)
+    {
+        int nr_sol_vectors_before = nr_sol_vectors;
+        double total = 0.0;
+        solutions = 0.0;
+        for (int probe = 0; probe < nr_probes; probe++)
+        {
+            double nodes = 1.0;
+            double width = 1.0;
+            bool pruned = false;
+            while (!pruned && matrix.r[root] != root && nr_pos_with_zero_vec == 0)
+            {
+                int best_nr;
+                Position best_pos = select_best_position(best_nr);
+                seed = mix_hash(seed);
+                Node node = matrix.d[best_pos];
+                for (uint64_t k = seed % best_nr; k > 0; k--)
+                    node = matrix.d[node];
+                Vector vector = matrix.vector[node];
+                width *= best_nr;
+                sol_vectors[nr_sol_vectors++] = vector;
+                selectVector(vector);
+                pruned = !symmetry_select(vector);
+                if (!pruned)
+                    nodes += width;
+            }
+            if (!pruned && matrix.r[root] == root && symmetry_canonical())
+                solutions += width * path_weight();
+            while (nr_sol_vectors > nr_sol_vectors_before)
+            {
+                Vector vector = sol_vectors[--nr_sol_vectors];
+                symmetry_unselect(vector);
+                unselectVector(vector);
+            }
+            total += nodes;
+        }
+        solutions /= nr_probes;
+        return total / nr_probes;
+    }
+
+    void estimate_search(const std::vector<std::vector<int> > &tasks)
+    {
+        PhaseTimer phaseTimer(*this, "estimate");
+        if (tasks.empty())
+            return;
+        long nr_probes = opt_estimate / (long)tasks.size();
+        if (nr_probes < 1)
+            nr_probes = 1;
+        double solutions = 0.0;
+        shared->estimated_nodes = 0.0;
+        for (size_t i = 0; i < tasks.size(); i++)
+        {
+            replay_path(tasks[i]);
+            double task_solutions;
+            shared->estimated_nodes += estimate_nodes(mix_hash(i + 1), nr_probes, task_solutions);
+            solutions += task_solutions;
+            unwind_path(tasks[i]);
+        }
+        if (flog == 0)
+            return;
+        fprintf(flog, "estimate: %.3g nodes, %.3g solutions (%ld probes)\n",
+                shared->estimated_nodes, solutions, nr_probes * (long)tasks.size());
+        if (opt_count && opt_count_table > 0)
+            fprintf(flog, "estimate: the count table will reduce the number of nodes\n");
+    }
+
+    // Sharding
+    //
+    // With -shard=i/n only the i-th of n parts of the search is done. All
+    // processes divide the search in the same way: the part of the search
+    // with the largest estimated size is split on the vectors of the column
+    // that solve() would branch on, until there are at least SHARD_TASKS_PER_SHARD
+    // parts per shard and none of them is larger than an eighth of a shard.
+    // The parts, in the order of the search, are then cut
+    // into n shards with about the same estimated size. Each part belongs to
+    // exactly one shard, such that the union of the output of all shards is
+    // equal to the output without sharding.
+
+#define SHARD_TASKS_PER_SHARD 64
+#define SHARD_MAX_TASKS_PER_SHARD 1024
+#define SHARD_PROBES 32
+
+    struct ShardTask
+    {
+        std::vector<int> path;
+        double estimate;
+        bool leaf;
+    };
+
+    static uint64_t path_seed(const std::vector<int> &path)
+    {
+        uint64_t seed = 0;
+        for (size_t i = 0; i < path.size(); i++)
+            seed = mix_hash(seed ^ (uint32_t)path[i]);
+        return seed;
+    }
+
+    // Replaces the task by a task for each vector of the column that the
+    // search branches on
+    void split_shard_task(std::vector<ShardTask> &tasks, size_t i)
+    {
+        std::vector<ShardTask> parts;
+        replay_path(tasks[i].path);
+        int best_nr;
+        Position best_pos = select_best_position(best_nr);
+        for (Node node = matrix.d[best_pos]; node != best_pos; node = matrix.d[node])
+        {
+            Vector vector = matrix.vector[node];
+            ShardTask part;
+            part.path = tasks[i].path;
+            part.path.push_back(vec(vector).nr);
+            selectVector(vector);
+            // Branches without solutions are dropped
+            bool keep = symmetry_select(vector) && nr_pos_with_zero_vec == 0;
+            if (keep)
+            {
+                part.leaf = matrix.r[root] == root;
+                double solutions;
+                part.estimate = part.leaf ? 1.0 : estimate_nodes(path_seed(part.path), SHARD_PROBES, solutions);
+            }
+            symmetry_unselect(vector);
+            unselectVector(vector);
+            if (keep)
+                parts.push_back(part);
+        }
+        unwind_path(tasks[i].path);
+        tasks.erase(tasks.begin() + i);
+        tasks.insert(tasks.begin() + i, parts.begin(), parts.end());
+    }
+
+    void select_shard_tasks()
+    {
+        PhaseTimer phaseTimer(*this, "shard");
+        std::vector<ShardTask> tasks(1);
+        tasks[0].leaf = matrix.r[root] == root || nr_pos_with_zero_vec > 0;
+        tasks[0].estimate = 1.0;
+        double total;
+        for (;;)
+        {
+            total = 0.0;
+            size_t largest = tasks.size();
+            for (size_t i = 0; i < tasks.size(); i++)
+            {
+                total += tasks[i].estimate;
+                if (!tasks[i].leaf && (largest == tasks.size() || tasks[i].estimate > tasks[largest].estimate))
+                    largest = i;
+            }
+            // Also split the tasks that are much larger than the average
+            // size of a shard, because their estimate is less accurate
+            if (   largest == tasks.size()
+                || tasks.size() >= (size_t)opt_nr_shards * SHARD_MAX_TASKS_PER_SHARD
+                || (   tasks.size() >= (size_t)opt_nr_shards * SHARD_TASKS_PER_SHARD
+                    && tasks[largest].estimate * opt_nr_shards * 8 <= total))
+                break;
+            split_shard_task(tasks, largest);
+        }
+        
+        double before = 0.0;
+        double estimate = 0.0;
+        for (size_t i = 0; i < tasks.size(); i++)
+        {
+            // The shard is determined by the middle of the task
+            int shard = (int)((before + tasks[i].estimate / 2) / total * opt_nr_shards);
+            if (shard >= opt_nr_shards)
+                shard = opt_nr_shards - 1;
+            if (shard == opt_shard - 1)
+            {
+                shared->start_tasks.push_back(tasks[i].path);
+                estimate += tasks[i].estimate;
+            }
+            before += tasks[i].estimate;
+        }
+        if (flog != 0)
+            fprintf(flog, "shard %d/%d: %lu of %lu tasks, %.1lf%% of the estimated nodes\n",
+                    opt_shard, opt_nr_shards, (unsigned long)shared->start_tasks.size(), (unsigned long)tasks.size(), 100.0 * estimate / total);
+    }
+
+    void write_profile(double total_time)
+    {
+        phase_time["ExactCover"] = total_time;
+        phase_self_time["ExactCover"] += total_time;
+        
+        FILE *f = fopen("profile.json", "wt");
+        if (f == 0)
+        {
+            fprintf(stderr, "Error: Cannot write profile.json\n");
+            return;
+        }
+        fprintf(f, "{\n  \"phases\": [");
+        const char *sep = "\n";
+        for (std::map<std::string, double>::iterator it = phase_time.begin(); it != phase_time.end(); it++)
+        {
+            fprintf(f, "%s    { \"phase\": \"%s\", \"seconds\": %.6lf, \"self_seconds\": %.6lf }",
+                    sep, it->first.c_str(), it->second, phase_self_time[it->first]);
+            sep = ",\n";
+        }
+        fprintf(f, "\n  ],\n  \"depths\": [");
+        sep = "\n";
+        for (size_t d = 0; d < depth_profile.size(); d++)
+        {
+            DepthProfile &stats = depth_profile[d];
+            fprintf(f, "%s    { \"depth\": %lu, \"nodes\": %ld, \"branches\": %ld, \"branching_factor\": %.3lf, "
+                       "\"dead_ends\": %ld, \"propagated\": %ld, \"solutions\": %ld, \"covers\": %ld, \"uncovers\": %ld, \"seconds\": %.6lf }",
+                    sep, (unsigned long)d, stats.nodes, stats.branches, stats.nodes > 0 ? (double)stats.branches / stats.nodes : 0.0,
+                    stats.dead_ends, stats.propagated, stats.solutions, stats.covers, stats.uncovers, stats.seconds);
+            sep = ",\n";
+        }
+        fprintf(f, "\n  ]\n}\n");
+        fclose(f);
+        
+        // The folded stacks contain the time in microseconds that is not spent
+        // in nested phases or in the nodes at the next depth
+        f = fopen("profile.folded", "wt");
+        if (f == 0)
+        {
+            fprintf(stderr, "Error: Cannot write profile.folded\n");
+            return;
+        }
+        const std::string search_phase = "ExactCover;search";
+        for (std::map<std::string, double>::iterator it = phase_self_time.begin(); it != phase_self_time.end(); it++)
+        {
+            double self_time = it->second;
+            if (it->first == search_phase && !depth_profile.empty())
+                self_time -= depth_profile[0].seconds;
+            if (self_time > 0.0)
+                fprintf(f, "%s %.0lf\n", it->first.c_str(), self_time * 1e6);
+        }
+        std::string stack = search_phase;
+        for (size_t d = 0; d < depth_profile.size(); d++)
+        {
+            char frame[30];
+            sprintf(frame, ";depth_%lu", (unsigned long)d);
+            stack += frame;
+            double self_time = depth_profile[d].seconds;
+            if (d + 1 < depth_profile.size())
+                self_time -= depth_profile[d + 1].seconds;
+            if (self_time > 0.0)
+                fprintf(f, "%s %.0lf\n", stack.c_str(), self_time * 1e6);
+        }
+        fclose(f);
+    }
+
+    // Lookahead with multiple threads
+    //
+    // With -threads=N, the reduction tries the vectors of a batch with
+    // possible() at the same time. Each thread has an engine of its own with
+    // a copy of the matrix, which is made once. Before each batch, it ignores
+    // the nodes that were ignored in the main matrix since the previous
+    // batch. The vectors found to be impossible are only removed after the
+    // whole batch has been tried.
+
+    struct Probe
+    {
+        Probe(Vector n_vector) : vector(n_vector), possible(true), nr_calls(0) {}
+        Vector vector;
+        bool possible;
+        int nr_calls;
+    };
+
+    // The engine of a thread of the lookahead, with the number of ignored
+    // nodes it has replayed
+    struct ProbeEngine
+    {
+        ECEngine *engine;
+        size_t nr_ignored;
+    };
+
+    std::vector<ProbeEngine> probe_engines;
+
+    void probe_worker(size_t nr_ignored, const IgnoredNodes* ignoredNodes,
+                      std::vector<Probe>* probes, std::atomic<size_t>* next_probe, int tries)
+    {
+        ignoredNodes->replay(*this, nr_ignored);
+        
+        for (size_t i; (i = (*next_probe)++) < probes->size();)
+        {
+            Probe &probe = (*probes)[i];
+            nr_calls = 0;
+            selectVector(probe.vector);
+            probe.possible = possible(tries);
+            unselectVector(probe.vector);
+            probe.nr_calls = nr_calls;
+        }
+    }
+
+    void probe_vectors(const IgnoredNodes &ignoredNodes, std::vector<Probe> &probes, int tries)
+    {
+        while (probe_engines.size() < (size_t)opt_threads)
+        {
+            ProbeEngine probe_engine;
+            probe_engine.engine = new ECEngine(*this, 0);
+            probe_engine.nr_ignored = ignoredNodes.size();
+            if (opt_nogood_table > 0)
+                probe_engine.engine->nogood_table = new CountTable(nr_uncovered_words(matrix.nr_positions), opt_nogood_table / opt_threads);
+            probe_engines.push_back(probe_engine);
+        }
+        
+        std::atomic<size_t> next_probe(0);
+        int nr_threads = std::min((size_t)opt_threads, probes.size());
+        std::vector<std::thread> threads;
+        for (int i = 0; i < nr_threads; i++)
+        {
+            threads.push_back(std::thread(&ECEngine::probe_worker, probe_engines[i].engine, probe_engines[i].nr_ignored,
+                                          &ignoredNodes, &probes, &next_probe, tries));
+            probe_engines[i].nr_ignored = ignoredNodes.size();
+        }
+        for (int i = 0; i < nr_threads; i++)
+            threads[i].join();
+        
+        for (size_t i = 0; i < probes.size(); i++)
+            total_nr_calls += probes[i].nr_calls;
+    }
+
+    void free_probe_engines()
+    {
+        for (size_t i = 0; i < probe_engines.size(); i++)
+        {
+            ECEngine *engine = probe_engines[i].engine;
+            if (engine->nogood_table != 0)
+            {
+                nr_nogood_hits += engine->nogood_table->nr_hits;
+                nr_nogood_misses += engine->nogood_table->nr_misses;
+                delete engine->nogood_table;
+                engine->nogood_table = 0;
+            }
+            delete engine;
+        }
+        probe_engines.clear();
+    }
+
+    // Orders of the vectors and positions that are tried during reduction
+
+    struct Hotter
+    {
+        Hotter(ECEngine &engine) : _engine(engine) {}
+        bool operator()(Vector vector1, Vector vector2) { return _engine.vec(vector1).hot > _engine.vec(vector2).hot; }
+        ECEngine &_engine;
+    };
+
+    long cold_score(Position position) { return pos(position).nr_vec_left - pos(position).hotpos; }
+    bool is_hot_position(Position position) { return pos(position).hotpos > 0; }
+
+    // Driving the solver
+    //
+    // The programs using the solver first build the matrix from a MatrixInput
+    // (with build_matrix), then reduce it with reduce_matrix, and search it
+    // with start_search and search. The ignored nodes of the reduction are
+    // restored when ignoredNodes goes out of scope.
+
+    // Returns whether there are columns without vectors, in which case there
+    // is no solution. These are written to log, when it is not 0.
+    bool find_empty_columns(FILE *log)
+    {
+        bool found = false;
+        for (Position position = matrix.r[root]; position != root; position = matrix.r[position])
+            if (pos(position).nr_vec_left == 0)
+            {
+                found = true;
+                if (log != 0)
+                    fprintf(log, "Column %d is empty.\n", pos(position).nr);
+            }
+        return found;
+    }
+
+    // Applies the reduction rules and removes the vectors that cannot be part
+    // of a solution (unless opt_reduce is false). With save_intermediate, the
+    // reduced exact cover is written to reduced.ec after each pass, in the
+    // numeric format when numeric is true.
+    void reduce_matrix(IgnoredNodes &ignoredNodes, bool save_intermediate, bool numeric)
+    {
+        start_time = clock();
+        start_periode = start_time;
+        backup_time = start_time;
+
+        if (opt_reduce)
+        {
+            int nr_hot = 0;
+            int nr_impos = 0;
+            int nr_pass = 0;
+            
+            int nr_tries = opt_reduce_tries > 0 ? opt_reduce_tries : 1000;
+            
+            if (opt_nogood_table > 0)
+                nogood_table = new CountTable(nr_uncovered_words(matrix.nr_positions), opt_nogood_table);
+
+            for (Position position = matrix.r[root]; position != root; position = matrix.r[position])
+                pos(position).hotpos = 1;
+
+            for (Position position1 = matrix.r[root]; position1 != root; position1 = matrix.r[position1])
+                pos(position1).needs_reducing = 1;
+
+            for (int changed = 1; changed > 0; )
+            {
+                reduce(ignoredNodes, true);
+                
+                nr_pass++;
+                changed = 0;
+                PhaseTimer phaseTimer(*this, "possible");
+
+                // Trying a vector does not change the hot counts of the other
+                // vectors, so they are tried in order of decreasing hot count.
+                std::vector<Vector> hot_vectors;
+                for (Vector vector = matrix.d[root]; vector != root; vector = matrix.d[vector])
+                {
+                    vec(vector).hot++;
+                    hot_vectors.push_back(vector);
+                }
+                std::stable_sort(hot_vectors.begin(), hot_vectors.end(), Hotter(*this));
+                
+                std::vector<Probe> probes;
+                if (opt_threads > 1)
+                {
+                    probes.assign(hot_vectors.begin(), hot_vectors.end());
+                    probe_vectors(ignoredNodes, probes, 1);
+                }
+
+                for (size_t i = 0; i < hot_vectors.size(); i++)
+                {
+                    Vector hottest_vector = hot_vectors[i];
+                    
+                    nr_hot++;
+                    bool pos;
+                    if (opt_threads > 1)
+                        pos = probes[i].possible;
+                    else
+                    {
+                        selectVector(hottest_vector);
+                        
+                        // Evaluate solution
+                        pos = possible(1);
+        
+                        unselectVector(hottest_vector);
+                    }
+                    
+                    if (!pos)
+                    {
+                        nr_impos++;
+                        if (flog != 0) fprintf(flog, "%*.*sremoved impossible %s\n", nr_sol_vectors, nr_sol_vectors, "", vec(hottest_vector).name);
+                        ignoredNodes.add(hottest_vector);
+                        changed++;
+                        vec(hottest_vector).hot = 0;
+                        //reduce(ignoredNodes, true);
+                    }
+                    vec(hottest_vector).hot = 0;
+                }
+                
+#if 0            
+                for (Vector vector = matrix.d[root]; vector != root; vector = matrix.d[vector])
+                {
+                    if (tracePrint())
+                        fprintf(stderr, "Trying to eliminate %s\n", vec(vector).name);
+
+                    selectVector(vector);
+                    
+                    // Evaluate solution
+                    bool pos = possible(1);
+
+                    unselectVector(vector);
+                    
+                    if (!pos)
+                    {
+                        nr_impos++;
+                        fprintf(stderr, "%*.*seliminated %s [%d:%d] %d\n", nr_sol_vectors, nr_sol_vectors, "", vec(vector).name, nr_vec, nr_hot, nr_calls);
+                        ignoredNodes.add(vector, true);
+                        reduce(ignoredNodes, true);
+                        changed++;
+                    }
+                    
+                    backup();
+                }
+                
+#endif
+
+                if (changed == 0)
+                {
+                    for (Vector vector = matrix.d[root]; vector != root; vector = matrix.d[vector])
+                    {
+                        nr_hot++;
+                        vec(vector).hot++;
+                    }
+        
+                    PositionQueue queue(*this, &ECEngine::cold_score, &ECEngine::is_hot_position);
+                    for (Position position = matrix.r[root]; position != root; position = matrix.r[position])
+                        queue.update(position);
+                    position_queue = &queue;
+                    
+                    for (;changed < 1000 || changed < nr_vec/10;)
+                    {
+                        if (queue.empty())
+                            break;
+                        
+                        long min_score = queue.top_score();
+                        if (flog != 0) fprintf(flog, "min score = %ld, nr = %d [%d:%d]\n", min_score, queue.nr_with_top_score(), nr_vec, nr_hot);
+        
+                        while (!queue.empty() && queue.top_score() == min_score)
+                        {
+                            Position position = queue.top();
+                            if (flog != 0) fprintf(flog, "cold: %d\n", pos(position).nr);
+                            
+                            bool some_removed = false;
+                            
+                            // With threads, the hot vectors of the column are tried as a batch
+                            std::vector<Probe> batch_probes;
+                            size_t nr_probed = 0;
+                            int batch_tries = nr_tries;
+                            if (opt_threads > 1)
+                            {
+                                for (Node node = matrix.d[position]; node != position; node = matrix.d[node])
+                                    if (vec(matrix.vector[node]).hot)
+                                        batch_probes.push_back(Probe(matrix.vector[node]));
+                                probe_vectors(ignoredNodes, batch_probes, batch_tries);
+                            }
+                            
+                            for (Node node = matrix.d[position]; node != position; node = matrix.d[node])
+                            {
+                                Vector vector = matrix.vector[node];
+                                if (opt_threads > 1 ? nr_probed < batch_probes.size() && batch_probes[nr_probed].vector == vector : vec(vector).hot)
+                                {
+                                    vec(vector).hot = false;
+                                    nr_hot--;
+                                    bool pos;
+                                    if (opt_threads > 1)
+                                    {
+                                        if (flog != 0) fprintf(flog, "possible = %d\n", batch_tries);
+                                        nr_calls = batch_probes[nr_probed].nr_calls;
+                                        pos = batch_probes[nr_probed++].possible;
+                                    }
+                                    else
+                                    {
+                                        nr_calls = 0;
+                                        position_queue = 0;
+                                        selectVector(vector);
+                                        
+                                        // Evaluate solution
+                                        if (flog != 0) fprintf(flog, "possible = %d\n", nr_tries);
+                                        pos = possible(nr_tries);
+                        
+                                        unselectVector(vector);
+                                        position_queue = &queue;
+                                    }
+                                    
+                                    if (!pos)
+                                    {
+                                        nr_impos++;
+                                        if (flog != 0) fprintf(flog, "%*.*sremoved impossible %s [%d:%d] %d\n", nr_sol_vectors, nr_sol_vectors, "", vec(vector).name, nr_vec, nr_hot, nr_calls);
+                                        /*for (Node node = matrix.r[vector]; node != vector; node = matrix.r[node])
+                                        {
+                                            if (pos(matrix.position[node]).hotpos == 0)
+                                            {
+                                                printf("hot %d\n", pos(matrix.position[node]).nr);
+                                                for (Node node2 = matrix.position[node]->d; node2 != matrix.position[node]; node2 = matrix.d[node2])
+                                                    if (!vec(matrix.vector[node2]).hot)
+                                                    {
+                                                        vec(matrix.vector[node2]).hot = true;
+                                                        nr_hot++;
+                                                    }
+                                            }
+                                            pos(matrix.position[node]).hotpos++;
+                                        }*/
+                                        ignoredNodes.add(vector, true);
+                                        changed++;
+                                        some_removed = true;
+                                        //if (nr_tries > 3)
+                                        //    nr_tries -= 3;
+                                    }
+                                    else
+                                    {
+                                        nr_tries++;
+                                        if (flog != 0)
+                                        {
+                                            fprintf(flog, "%d:%d ", nr_calls, nr_tries);
+                                            fflush(flog);
+                                        }
+                                    }
+                                    //else if (tracePrint())
+                                    //    printf("%*.*spossible %s (%d)\n", nr_sol_vectors, nr_sol_vectors, "", vec(vector).name, nr_hot);
+                                }
+                            }
+                            pos(position).hotpos = 0;
+                            queue.update(position);
+                            
+                            if (some_removed)
+                            {
+                                if (flog != 0) fprintf(flog, "Reduce:\n");
+                                PhaseTimer reduceTimer(*this, "reduce");
+                                reduce(position, ignoredNodes, true);
+                            }
+                            
+                            backup();
+                        }
+                    }
+                    position_queue = 0;
+                }
+                
+                if (changed > 0 && save_intermediate)
+                {
+                    FILE *f = fopen("reduced.ec","wt");
+                    if (numeric)
+                        print_numeric(f);
+                    else
+                        print(f);
+                    fclose(f);
+                }
+            }
+            if (flog != 0) fprintf(flog, "%*.*s%d:%d %d\n", nr_sol_vectors, nr_sol_vectors, "", nr_hot, nr_impos, nr_pass);
+            free_probe_engines();
+            if (nogood_table != 0)
+            {
+                nr_nogood_hits += nogood_table->nr_hits;
+                nr_nogood_misses += nogood_table->nr_misses;
+                delete nogood_table;
+                nogood_table = 0;
+                if (flog != 0) fprintf(flog, "nogood table: %ld hits, %ld misses\n", nr_nogood_hits, nr_nogood_misses);
+            }
+
+            //print(stdout);
+        }
+        
+        
+        if (flog != 0) fprintf(flog, "total nr of calls = %ld\n", total_nr_calls);
+    }
+
+    // Prepares the search: reads the checkpoint to resume from, and divides
+    // the search in shards and estimates its size, when requested. Returns
+    // whether the output has been truncated to the checkpoint.
+    bool start_search(ECSolutionVisitor *visitor)
+    {
+        shared->solution_visitor = visitor;
+        sol_found_in_periode = 0;
+
+        bool output_truncated = false;
+        if (opt_checkpoint != 0)
+            checkpoint_fingerprint = matrix_fingerprint();
+        if (opt_resume != 0)
+            output_truncated = read_checkpoint(opt_resume);
+        if (opt_checkpoint != 0)
+            next_checkpoint = time(0) + opt_checkpoint_interval;
+
+        shared->start_tasks.clear();
+        shared->next_start_task = 0;
+        if (opt_nr_shards > 0)
+            select_shard_tasks();
+        else
+            shared->start_tasks.push_back(std::vector<int>()); // the whole search
+        if (opt_estimate > 0)
+        {
+            estimate_search(shared->start_tasks);
+            if (!opt_only_estimate)
+            {
+                shared->search_start_time = time(0);
+                shared->nr_nodes_before_search = nr_calls_to_solve;
+                shared->next_progress = shared->search_start_time + PROGRESS_INTERVAL;
+            }
+        }
+        return output_truncated;
+    }
+
+    // Searches the solutions, with threads or the bitset engine when possible,
+    // and passes them to the visitor (when not counting). Returns the number
+    // of solutions.
+    long search(ECSolutionVisitor *visitor)
+    {
+        shared->solution_visitor = visitor;
+        shared->search_stopped = false;
+        {
+            PhaseTimer phaseTimer(*this, "search");
+            if (opt_threads > 1)
+                solve_with_threads();
+            else if (opt_bitset && nr_pos <= 64 && opt_nr_shards == 0)
+            {
+                if (flog != 0) fprintf(flog, "Using bitset engine with 64 bits masks\n");
+                if (opt_count && opt_count_table > 0)
+                    count_table = new CountTable(1, opt_count_table);
+                BitsetSolver<uint64_t> bitsetSolver(*this);
+                bitsetSolver.solve();
+            }
+            else if (opt_bitset && nr_pos <= 128 && opt_nr_shards == 0)
+            {
+                if (flog != 0) fprintf(flog, "Using bitset engine with 128 bits masks\n");
+                if (opt_count && opt_count_table > 0)
+                    count_table = new CountTable(2, opt_count_table);
+                BitsetSolver<__uint128_t> bitsetSolver(*this);
+                bitsetSolver.solve();
+            }
+            else
+            {
+                if (opt_count && opt_count_table > 0)
+                    count_table = new CountTable(nr_uncovered_words(matrix.nr_positions), opt_count_table);
+                for (size_t i = 0; i < shared->start_tasks.size() && !shared->search_stopped; i++)
+                    solve_task(shared->start_tasks[i]);
+            }
+        }
+        if (count_table != 0)
+        {
+            nr_count_hits = count_table->nr_hits;
+            nr_count_misses = count_table->nr_misses;
+            delete count_table;
+            count_table = 0;
+        }
+        if (opt_checkpoint != 0)
+            remove(opt_checkpoint);
+        return nr_solutions;
+    }
+
+    void write_statistics(FILE *f)
+    {
+        if (opt_count)
+            fprintf(f, "count table: %ld hits, %ld misses\n", nr_count_hits, nr_count_misses);
+        clock_t now = clock();
+        while (now > start_periode + 1000)
+        {
+            fprintf(f, "%d\n", sol_found_in_periode);
+            sol_found_in_periode = 0;
+            start_periode += 1000;
+        }
+        // After resuming, the time of the runs before the checkpoint is included
+        double total_time = time_before_resume + (now - start_time)/1000.0;
+        fprintf(f, "total time = %lf\n", total_time);
+        fprintf(f, "nr solution = %ld (%lf/sec)\n", nr_solutions, nr_solutions/total_time);
+        fprintf(f, "nr calls to solve = %ld\n", nr_calls_to_solve);
+        if (opt_propagate > 0)
+            fprintf(f, "nr vectors removed by propagation = %ld\n", nr_propagated);
+        if (opt_components)
+            fprintf(f, "nr nodes split into components = %ld\n", nr_component_splits);
+    }
+
+private:
+    Shared _main_shared;
+};
+
+#ifdef __AVX2__
+// Filtering four 64 bits masks at the time
+template <>
+inline void ECEngine::BitsetSolver<uint64_t>::filter(Level &from, uint64_t sel_mask, Level &to)
+{
+    to.reserve(from.n);
+    for (int c = 0; c < _nr_pos; c++)
+        to.counts[c] = 0;
+    
+    __m256i sel = _mm256_set1_epi64x((long long)sel_mask);
+    __m256i zero = _mm256_setzero_si256();
+    size_t j = 0;
+    size_t i = 0;
+    for (; i + 4 <= from.n; i += 4)
+    {
+        __m256i masks = _mm256_loadu_si256((__m256i*)(from.masks + i));
+        int keep = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(masks, sel), zero)));
+        for (; keep != 0; keep &= keep - 1)
+        {
+            size_t k = i + __builtin_ctz(keep);
+            to.masks[j] = from.masks[k];
+            to.vectors[j] = from.vectors[k];
+            add_counts(to.counts, from.masks[k]);
+            j++;
+        }
+    }
+    for (; i < from.n; i++)
+        if ((from.masks[i] & sel_mask) == 0)
+        {
+            to.masks[j] = from.masks[i];
+            to.vectors[j] = from.vectors[i];
+            add_counts(to.counts, from.masks[i]);
+            j++;
+        }
+    to.n = j;
+}
+#endif
+
+// An exact cover that is solved in-process. All rows have to be added
+// before the first call of solve or count. The options of the search are
+// set with options(). Nothing is logged, unless flog is set.
+class ECSolver
+{
+public:
+    ECSolver(uint32_t nr_columns) : _built(false) { _input.nr_positions = nr_columns; }
+    
+    // Adds a row with the columns for which vector is true, and returns
+    // its number
+    uint32_t add_row(const bool *vector, const char *name = "")
+    {
+        for (int i = 0; i < _input.nr_positions; i++)
+            if (vector[i])
+                _input.entries.push_back(i);
+        _input.add_vector(name, strlen(name));
+        return nr_rows() - 1;
+    }
+    
+    uint32_t add_row(const uint32_t *columns, size_t nr_columns, const char *name = "")
+    {
+        _input.entries.insert(_input.entries.end(), columns, columns + nr_columns);
+        _input.add_vector(name, strlen(name));
+        return nr_rows() - 1;
+    }
+    
+    uint32_t nr_columns() const { return _input.nr_positions; }
+    uint32_t nr_rows() const { return _input.names.size(); }
+    const int *row_begin(uint32_t row) const { return _input.entries.data() + _input.vector_start[row]; }
+    const int *row_end(uint32_t row) const { return _input.entries.data() + _input.vector_start[row + 1]; }
+    const char *name(uint32_t row) const { return _input.names[row]; }
+    
+    ECOptions &options() { return _engine; }
+    
+    // Passes each solution to the visitor. Returns true when the visitor
+    // stopped the search.
+    bool solve(ECSolutionVisitor &visitor) { return run(&visitor); }
+    
+    long count()
+    {
+        bool count = _engine.opt_count;
+        _engine.opt_count = true;
+        run(0);
+        _engine.opt_count = count;
+        return _engine.nr_solutions;
+    }
+
+private:
+    bool run(ECSolutionVisitor *visitor)
+    {
+        if (!_built)
+        {
+            // build_matrix merges the duplicates in its input, while the
+            // rows are kept for row_begin and row_end
+            MatrixInput input;
+            input.nr_positions = _input.nr_positions;
+            input.entries = _input.entries;
+            input.vector_start = _input.vector_start;
+            input.names = _input.names;
+            _engine.build_matrix(input);
+            if (_engine.opt_symmetry != 0)
+            {
+                _engine.read_symmetry(_engine.opt_symmetry);
+                _engine.init_symmetry(input);
+            }
+            _built = true;
+        }
+        _engine.nr_solutions = 0;
+        if (_engine.find_empty_columns(0))
+            return false;
+        
+        ECEngine::IgnoredNodes ignoredNodes(_engine);
+        _engine.reduce_matrix(ignoredNodes, false, false);
+        _engine.start_search(visitor);
+        _engine.search(visitor);
+        return _engine.stopped();
+    }
+    
+    ECEngine _engine;
+    MatrixInput _input;
+    bool _built;
+};
+
+#endif
@@ -30,6 +30,8 @@ Details:
 #include <math.h>
 
 #include "insertonlymap.h" // http://www.iwriteiam.nl/insertonlymap3_h.txt
+#include "ecbinary.h"
+#include "ecsolver.h"
 
 // Hexagonal transformation matrices
 
@@ -229,6 +231,52 @@ private:
 };
 
 
+// Output of the vectors for the Exact Cover
+
+ECBinaryWriter *ec_binary_writer = 0;
+
+// The exact cover that the puzzles command solves in-process, with the
+// piece number of each row
+struct SolverRows
+{
+	SolverRows() : solver(POSITIONS) {}
+	ECSolver solver;
+	std::vector<int> piece_nrs;
+};
+
+void output_ec_vector(const bool *vector, int piece_nr, SolverRows *solver_rows = 0)
+{
+	char name[10 + 4 * POSITIONS];
+	char *s = name;
+	if (piece_nr > 0)
+		s += sprintf(s, "%d on ", piece_nr);
+	char sep = '\0';
+	for (int i = 0; i < POSITIONS; i++)
+		if (vector[i])
+		{
+			if (sep != '\0')
+				*s++ = sep;
+			s += sprintf(s, "%d", i);
+			sep = ',';
+		}
+	*s = '\0';
+	
+	if (ec_binary_writer != 0)
+	{
+		ec_binary_writer->add_row(vector, name);
+		return;
+	}
+	if (solver_rows != 0)
+	{
+		solver_rows->solver.add_row(vector, name);
+		solver_rows->piece_nrs.push_back(piece_nr);
+		return;
+	}
+	for (int i = 0; i < POSITIONS; i++)
+		printf("%c", vector[i] ? '1' : '0');
+	printf(" %s\n", name);
+}
+
 // Generate to Exact Cover with hard coded pieces
 
 const int HC_PIECES_FIELD_SIZE = 16;
@@ -394,20 +442,10 @@ void generate_ec_from_hardcode(bool with_piece_number)
 	for (Placements::iterator it(all_placements); it.more(); it.next())
 	{
 		// generate vector
+		bool vector[POSITIONS];
 		for (int i = 0; i < POSITIONS; i++)
-			printf("%d", it.key()[i]);
-		
-		if (with_piece_number)
-			printf(" %d on", it.value().nr);
-		
-		char c = ' ';
-		for (int i = 0; i < POSITIONS; i++)
-			if (it.key()[i])
-			{
-				printf("%c%d", c, i);
-				c = ',';
-			}
-		printf("\n");
+			vector[i] = it.key()[i];
+		output_ec_vector(vector, with_piece_number ? it.value().nr : 0);
 	}
 }
 
@@ -571,29 +609,16 @@ int groupFor(int i)
 	return i;
 }
 
-void fill(int white_n, int nr_set, int nr_groups, bool with_piece_number)
+void fill(int white_n, int nr_set, int nr_groups, bool with_piece_number, SolverRows *solver_rows)
 {
 	if (white_n == WHITE_POSITIONS)
 	{
 		if (range[nr_set] && nr_groups == 1)
-		{
-			for (int i = 0; i < POSITIONS; i++)
-				printf("%c", vector[i] ? '1' : '0');
-			if (with_piece_number)
-				printf(" %d on", pieceNumberForCurrent());
-			char sep = ' ';
-			for (int i = 0; i < POSITIONS; i++)
-				if (vector[i])
-				{
-					printf("%c%d", sep, i);
-					sep = ',';
-				}
-			printf("\n");
-		}
+			output_ec_vector(vector, with_piece_number ? pieceNumberForCurrent() : 0, solver_rows);
 		return;
 	}
 	
-	fill(white_n + 1, nr_set, nr_groups, with_piece_number);
+	fill(white_n + 1, nr_set, nr_groups, with_piece_number, solver_rows);
 	
 	if (nr_set >= max_set)
 		return;
@@ -645,7 +670,7 @@ void fill(int white_n, int nr_set, int nr_groups, bool with_piece_number)
 				{
 			 		groups[new_group_x] = new_group_y;
 			 		group[x][y] = new_group_y;
-			 		fill(white_n + 1, nr_set+1, nr_groups-1, with_piece_number);
+			 		fill(white_n + 1, nr_set+1, nr_groups-1, with_piece_number, solver_rows);
 			 		group[x][y] = -1;
 			 		groups[new_group_x] = -1;
 			 	}
@@ -653,7 +678,7 @@ void fill(int white_n, int nr_set, int nr_groups, bool with_piece_number)
 				{
 			 		groups[new_group_y] = new_group_x;
 			 		group[x][y] = new_group_x;
-			 		fill(white_n + 1, nr_set+1, nr_groups-1, with_piece_number);
+			 		fill(white_n + 1, nr_set+1, nr_groups-1, with_piece_number, solver_rows);
 			 		group[x][y] = -1;
 			 		groups[new_group_y] = -1;
 			 	}
@@ -668,7 +693,7 @@ void fill(int white_n, int nr_set, int nr_groups, bool with_piece_number)
 			if (old_group_y == -1)
 			{
 				group[x][y] = new_group_x;
-				fill(white_n + 1, nr_set+1, nr_groups, with_piece_number);
+				fill(white_n + 1, nr_set+1, nr_groups, with_piece_number, solver_rows);
 				group[x][y] = -1;
 			}
 
@@ -689,7 +714,7 @@ void fill(int white_n, int nr_set, int nr_groups, bool with_piece_number)
 				}
 
 				group[x][y] = new_group_y;
-				fill(white_n + 1, nr_set+1, nr_groups, with_piece_number);
+				fill(white_n + 1, nr_set+1, nr_groups, with_piece_number, solver_rows);
 				group[x][y] = -1;
 
 				if (old_group_y == -1)
@@ -701,7 +726,7 @@ void fill(int white_n, int nr_set, int nr_groups, bool with_piece_number)
 			if (old_group_y == -1)
 			{
 				group[x][y] = next_group++;
-				fill(white_n + 1, nr_set+1, nr_groups+1, with_piece_number);
+				fill(white_n + 1, nr_set+1, nr_groups+1, with_piece_number, solver_rows);
 				group[x][y] = -1;
 				next_group--;
 			}
@@ -750,7 +775,7 @@ void fill(int white_n, int nr_set, int nr_groups, bool with_piece_number)
 				{
 			 		groups[new_group_xy] = new_group_f;
 			 		group[x][y] = new_group_f;
-			 		fill(white_n + 1, nr_set+1, nr_groups-1, with_piece_number);
+			 		fill(white_n + 1, nr_set+1, nr_groups-1, with_piece_number, solver_rows);
 			 		group[x][y] = -1;
 			 		groups[new_group_xy] = -1;
 			 	}
@@ -758,7 +783,7 @@ void fill(int white_n, int nr_set, int nr_groups, bool with_piece_number)
 				{
 			 		groups[new_group_f] = new_group_xy;
 			 		group[x][y] = new_group_xy;
-			 		fill(white_n + 1, nr_set+1, nr_groups-1, with_piece_number);
+			 		fill(white_n + 1, nr_set+1, nr_groups-1, with_piece_number, solver_rows);
 			 		group[x][y] = -1;
 			 		groups[new_group_f] = -1;
 			 	}
@@ -772,7 +797,7 @@ void fill(int white_n, int nr_set, int nr_groups, bool with_piece_number)
 			if (old_group_f == -1)
 			{
 				group[x][y] = new_group_xy;
-				fill(white_n + 1, nr_set+1, nr_groups, with_piece_number);
+				fill(white_n + 1, nr_set+1, nr_groups, with_piece_number, solver_rows);
 				group[x][y] = -1;
 			}
 
@@ -793,7 +818,7 @@ void fill(int white_n, int nr_set, int nr_groups, bool with_piece_number)
 				}
 
 				group[x][y] = new_group_f;
-				fill(white_n + 1, nr_set+1, nr_groups, with_piece_number);
+				fill(white_n + 1, nr_set+1, nr_groups, with_piece_number, solver_rows);
 				group[x][y] = -1;
 
 				if (old_group_f == -1)
@@ -806,7 +831,7 @@ void fill(int white_n, int nr_set, int nr_groups, bool with_piece_number)
 			if (old_group_f == -1)
 			{
 				group[x][y] = next_group++;
-				fill(white_n + 1, nr_set+1, nr_groups+1, with_piece_number);
+				fill(white_n + 1, nr_set+1, nr_groups+1, with_piece_number, solver_rows);
 				group[x][y] = -1;
 				next_group--;
 			}
@@ -815,7 +840,7 @@ void fill(int white_n, int nr_set, int nr_groups, bool with_piece_number)
 	vector[field_numbers[x][y]] = false;
 }
 
-void generate_ec(bool with_piece_number)
+void generate_ec(bool with_piece_number, SolverRows *solver_rows)
 {
 	for (int i = 0; i < POSITIONS; i++)
 	{
@@ -837,7 +862,7 @@ void generate_ec(bool with_piece_number)
 		}
 	}
 		
-	fill(0, 0, 0, with_piece_number);
+	fill(0, 0, 0, with_piece_number, solver_rows);
 }
 
 // Iterator for Exact Cover output
@@ -879,6 +904,12 @@ public:
 			for (int i = 0; i < POSITIONS; i++)
 			{
 				int piece_nr = piece_numbers[trans[t][i]];
+				// A position that no piece of the solution covers
+				if (piece_nr == -1)
+				{
+					candidate.piece_numbers[i] = -1;
+					continue;
+				}
 				if (mapping[piece_nr] == -1)
 				{
 					mapping[piece_nr] = candidate.nr_pieces++;
@@ -904,6 +935,37 @@ public:
 		}
 	}
 	
+	// Returns the value that normalize sets in minimal, by comparing the
+	// transformations only up to their first difference
+	bool isMinimal()
+	{
+		for (int t = 1; t < 6; t++)
+		{
+			int mapping[MAX_NR_PIECES_IN_SOL];
+			int mapping_t[MAX_NR_PIECES_IN_SOL];
+			for (int i = 0; i < nr_pieces; i++)
+				mapping[i] = mapping_t[i] = -1;
+			int nr = 0;
+			int nr_t = 0;
+			for (int i = 0; i < POSITIONS; i++)
+			{
+				int piece_nr = piece_numbers[trans[0][i]];
+				if (mapping[piece_nr] == -1)
+					mapping[piece_nr] = nr++;
+				int piece_nr_t = piece_numbers[trans[t][i]];
+				if (mapping_t[piece_nr_t] == -1)
+					mapping_t[piece_nr_t] = nr_t++;
+				if (mapping_t[piece_nr_t] != mapping[piece_nr])
+				{
+					if (mapping_t[piece_nr_t] < mapping[piece_nr])
+						return false;
+					break;
+				}
+			}
+		}
+		return true;
+	}
+	
 	void print(FILE *f)
 	{
 		for (int p = 0; p < nr_pieces; p++)
@@ -926,10 +988,42 @@ public:
 class SolutionIterator : public Solution
 {
 public:
-	SolutionIterator(FILE *f) : _f(f) { next(); }
+	SolutionIterator(FILE *f) : _f(f), _binary(0)
+	{
+		// The binary format (see ecbinary.h) is recognized on its magic
+		int ch = getc(f);
+		ungetc(ch, f);
+		if (ch == EC_SOLUTIONS_MAGIC[0])
+		{
+			_binary = new ECSolutionReader(f);
+			const char *error = _binary->open();
+			if (error != 0)
+			{
+				fprintf(stderr, "error: %s\n", error);
+				exit(1);
+			}
+			// Parse the names of the rows once
+			_row_pieces.resize(_binary->nr_rows());
+			for (size_t row = 0; row < _binary->nr_rows(); row++)
+			{
+				char *s = (char*)_binary->name(row);
+				NamedPiece &piece = _row_pieces[row];
+				piece.nr = -1;
+				if (*s != '\0')
+					parse_piece(s, piece.nr, piece.positions);
+			}
+		}
+		next();
+	}
+	~SolutionIterator() { delete _binary; }
 	bool more() { return _more; }
 	void next()
 	{
+		if (_binary != 0)
+		{
+			next_binary();
+			return;
+		}
 		char buffer[600];
 		if (!(_more = fgets(buffer, 600, _f))) return;
 		
@@ -938,36 +1032,84 @@ public:
 				
 		nr_pieces = 0;
 		char *s = buffer;
+		std::vector<int> positions;
 		while (*s != '\n' && *s != '\n' && *s != '\0')
 		{
-			int n;
-			if (!parse_number(s, n))
+			if (nr_pieces == MAX_NR_PIECES_IN_SOL)
+				too_many_pieces();
+			if (!parse_piece(s, pieces[nr_pieces].nr, positions))
 				break;
-			if (strncmp(s, " on ", 4) == 0)
-			{
-				s += 4;
-				pieces[nr_pieces].nr = n;
-				if (!parse_number(s, n))
-					break;
-			}
-			else
-				pieces[nr_pieces].nr = 0;
-			for(;;)
-			{
-				if (n < 0 || n >= POSITIONS)
-					break;
-				piece_numbers[n] = nr_pieces;
-				if (*s != ',') break;
-				s++;
-				if (!parse_number(s, n))
-					break;
-			}
+			for (size_t i = 0; i < positions.size(); i++)
+				piece_numbers[positions[i]] = nr_pieces;
 			if (*s == '|')
 				s++;
 			nr_pieces++;
 		}
 	}
 private:
+	void next_binary()
+	{
+		std::vector<uint32_t> rows;
+		if (!(_more = _binary->next(rows)))
+		{
+			if (_binary->error() != 0)
+			{
+				fprintf(stderr, "error: %s\n", _binary->error());
+				exit(1);
+			}
+			return;
+		}
+		
+		for (int i = 0; i < POSITIONS; i++)
+				piece_numbers[i] = -1;
+				
+		nr_pieces = 0;
+		for (size_t r = 0; r < rows.size(); r++)
+		{
+			NamedPiece &piece = _row_pieces[rows[r]];
+			if (piece.nr == -1)
+				continue;
+			if (nr_pieces == MAX_NR_PIECES_IN_SOL)
+				too_many_pieces();
+			pieces[nr_pieces].nr = piece.nr;
+			for (size_t i = 0; i < piece.positions.size(); i++)
+				piece_numbers[piece.positions[i]] = nr_pieces;
+			nr_pieces++;
+		}
+	}
+	void too_many_pieces()
+	{
+		fprintf(stderr, "error: a solution has more than %d pieces\n", MAX_NR_PIECES_IN_SOL);
+		exit(1);
+	}
+	// Parses a piece of the form [<nr> on ]<pos>{,<pos>}
+	bool parse_piece(char *&s, int &nr, std::vector<int> &positions)
+	{
+		positions.clear();
+		int n;
+		if (!parse_number(s, n))
+			return false;
+		if (strncmp(s, " on ", 4) == 0)
+		{
+			s += 4;
+			nr = n;
+			if (!parse_number(s, n))
+				return false;
+		}
+		else
+			nr = 0;
+		for(;;)
+		{
+			if (n < 0 || n >= POSITIONS)
+				break;
+			positions.push_back(n);
+			if (*s != ',') break;
+			s++;
+			if (!parse_number(s, n))
+				break;
+		}
+		return true;
+	}
 	bool parse_number(char *&s, int &number)
 	{
 		number = 0;
@@ -981,6 +1123,13 @@ private:
 	}
 	bool _more; 
 	FILE *_f;
+	ECSolutionReader *_binary;
+	struct NamedPiece
+	{
+		int nr;
+		std::vector<int> positions;
+	};
+	std::vector<NamedPiece> _row_pieces;
 };
 
 class PieceOccurances
@@ -1068,6 +1217,18 @@ public:
 		}
 		printf("\n");
 	}
+	void getSignature(std::string &signature)
+	{
+		signature.clear();
+		for (int i = 0; i < nr_used_pieces; i++)
+			for (int j = 0; j < used_pieces[i].occurances; j++)
+			{
+				char nr[20];
+				sprintf(nr, "%s%d", signature.empty() ? "" : ",", used_pieces[i].piece_nr);
+				signature += nr;
+			}
+	}
+
 	void getSignature(char *buffer)
 	{
 		buffer[0] = '\0';
@@ -1095,7 +1256,80 @@ public:
 	int max_occ;
 };
 
-	
+// Counting the puzzles of the solutions found by the solver of ExactCover
+// (see ecsolver.h), which does the same as:
+//   ExactCover | normalize -minimal | used_pieces | sort | uniq -c | sort -g
+
+class PuzzleCount
+{
+public:
+	PuzzleCount(const PieceOccurances &) : nr(0) {}
+	unsigned long nr;
+};
+
+class Puzzles : public InsertOnlyMap<PieceOccurances, PuzzleCount> {};
+
+struct PuzzleLine
+{
+	unsigned long nr;
+	std::string signature;
+};
+
+bool less_puzzle_line(const PuzzleLine &lhs, const PuzzleLine &rhs)
+{
+	if (lhs.nr != rhs.nr)
+		return lhs.nr < rhs.nr;
+	return lhs.signature < rhs.signature;
+}
+
+class PuzzleCounter : public ECSolutionVisitor
+{
+public:
+	PuzzleCounter(ECSolver &solver, const std::vector<int> &row_piece_nrs) : _solver(solver), _row_piece_nrs(row_piece_nrs) {}
+	virtual bool solution(const uint32_t *rows, size_t nr_rows)
+	{
+		Solution solution;
+		for (int i = 0; i < POSITIONS; i++)
+			solution.piece_numbers[i] = -1;
+		for (size_t r = 0; r < nr_rows; r++)
+		{
+			solution.pieces[solution.nr_pieces].nr = _row_piece_nrs[rows[r]];
+			for (const int *c = _solver.row_begin(rows[r]); c != _solver.row_end(rows[r]); c++)
+				solution.piece_numbers[*c] = solution.nr_pieces;
+			solution.nr_pieces++;
+		}
+
+		// Only one of the rotations and reflections of a solution is minimal
+		if (solution.isMinimal())
+		{
+			PieceOccurances pieceOccurances(solution);
+			_puzzles.findOrCreate(pieceOccurances)->nr++;
+		}
+		return false;
+	}
+	void print(FILE *f)
+	{
+		std::vector<PuzzleLine> lines;
+		for (Puzzles::iterator it(_puzzles); it.more(); it.next())
+		{
+			PuzzleLine line;
+			line.nr = it.value().nr;
+			PieceOccurances pieceOccurances = it.key();
+			pieceOccurances.getSignature(line.signature);
+			lines.push_back(line);
+		}
+		std::sort(lines.begin(), lines.end(), less_puzzle_line);
+		for (size_t i = 0; i < lines.size(); i++)
+			fprintf(f, "%7lu %s\n", lines[i].nr, lines[i].signature.c_str());
+	}
+
+private:
+	ECSolver &_solver;
+	const std::vector<int> &_row_piece_nrs;
+	Puzzles _puzzles;
+};
+
+
 // Print solution
 
 class PrintSol : public PrintBoard
@@ -1596,8 +1830,11 @@ void print_usage(const char *program_name)
 {
 	fprintf(stderr,
 			"Usage:\n"
-			"  %s gen_ec_hc [-with_name]\n"
-			"  %s gen_ec [-con] [-range=n,n-n,n-] [-with_name]\n"
+			"  %s gen_ec_hc [-with_name] [-binary]\n"
+			"  %s gen_ec [-con] [-range=n,n-n,n-] [-with_name] [-binary]\n"
+			"  %s puzzles [-con] [-range=n,n-n,n-]\n"
+			"  %s symmetry\n"
+			"  %s to_text\n"
 			"  %s normalize [-minimal]\n"
 			"  %s used_pieces [-max_occ=n] [-sup_occ=n] [-max=n] [-min=n]\n"
 			"  %s filter (<pieces>)\n"
@@ -1606,7 +1843,8 @@ void print_usage(const char *program_name)
 			"         [-stroke_width=r] [-space=r] [-side_length=r]\n"
 			"         [-bottom] [-width=r] [-height=r] [-margin=r]\n",
 			program_name, program_name, program_name, program_name,
-			program_name, program_name, program_name);
+			program_name, program_name, program_name, program_name,
+			program_name, program_name);
 }
 
 int main(int argc, char *argv[])
@@ -1618,21 +1856,32 @@ int main(int argc, char *argv[])
 	if (strcmp(argv[1], "gen_ec_hc") == 0)
 	{
 		bool with_name = false;
-		if (argc > 3) { print_usage(argv[0]); return 1; }
-		if (argc == 3)
+		bool binary = false;
+		for (int i = 2; i < argc; i++)
 		{
-			if (strcmp(argv[2], "-with_name") != 0) { print_usage(argv[0]); return 1; }
-			with_name = true;
+			if (strcmp(argv[i], "-with_name") == 0)
+				with_name = true;
+			else if (strcmp(argv[i], "-binary") == 0)
+				binary = true;
+			else { print_usage(argv[0]); return 1; }
 		}
+		if (binary)
+			ec_binary_writer = new ECBinaryWriter(POSITIONS);
 		generate_ec_from_hardcode(with_name);
+		if (binary)
+			ec_binary_writer->write(stdout);
 	}
-	else if (strcmp(argv[1], "gen_ec") == 0)
+	else if (strcmp(argv[1], "gen_ec") == 0 || strcmp(argv[1], "puzzles") == 0)
 	{
+		// The puzzles command solves the generated Exact Cover in-process
+		// and counts the solutions of each puzzle
+		bool puzzles = strcmp(argv[1], "puzzles") == 0;
 		for (int i = 0; i <= WHITE_POSITIONS; i++)
 			range[i] = false;
 		max_set = 0;
 		bool include_con = false;
-		bool with_name = false;
+		bool with_name = puzzles;
+		bool binary = false;
 			
 		for (int i = 2; i < argc; i++)
 		{
@@ -1695,8 +1944,10 @@ int main(int argc, char *argv[])
 						s++;
 				}
 			}
-			else if (strcmp(argv[i], "-with_name") == 0)
+			else if (!puzzles && strcmp(argv[i], "-with_name") == 0)
 				with_name = true;
+			else if (!puzzles && strcmp(argv[i], "-binary") == 0)
+				binary = true;
 			else
 			{ 
 				fprintf(stderr, "error: unknown option %s\n", argv[i]);
@@ -1710,21 +1961,74 @@ int main(int argc, char *argv[])
 			max_set = WHITE_POSITIONS;
 		}
 
+		if (binary)
+			ec_binary_writer = new ECBinaryWriter(POSITIONS);
+		SolverRows solver_rows;
+
 		if (include_con)
 		{
 			for (int i = 1; i <= FIELD_SIZE; i++)
 				for (int j = 1; j <= FIELD_SIZE; j++)
 					if (field[i][j] == 'X')
 					{
-						int num = field_numbers[i][j];
-						for (int i = 0; i < POSITIONS; i++)
-							printf("%c", i == num ? '1' : '0');
-						if (with_name)
-							printf(" 1 on");
-						printf(" %d\n", num);
+						bool con_vector[POSITIONS];
+						for (int k = 0; k < POSITIONS; k++)
+							con_vector[k] = k == field_numbers[i][j];
+						output_ec_vector(con_vector, with_name ? 1 : 0, puzzles ? &solver_rows : 0);
 					}
 		} 
-		generate_ec(with_name);
+		generate_ec(with_name, puzzles ? &solver_rows : 0);
+		if (binary)
+			ec_binary_writer->write(stdout);
+		if (puzzles)
+		{
+			PuzzleCounter puzzleCounter(solver_rows.solver, solver_rows.piece_nrs);
+			solver_rows.solver.solve(puzzleCounter);
+			puzzleCounter.print(stdout);
+		}
+	}
+	else if (strcmp(argv[1], "symmetry") == 0)
+	{
+		// The rotations and reflections of the field as permutations
+		// of the positions, to be used with: ExactCover -symmetry=file
+		// The solver only uses them when they map the piece positions
+		// onto each other, which is the case for gen_ec_hc, but not for
+		// gen_ec with pieces of four or more units, because fill() does
+		// not generate every piece position in all rotations.
+		if (argc > 2) { print_usage(argv[0]); return 1; }
+		fprintf(stderr, "Note: only useful for gen_ec_hc and for gen_ec with a range up to 3\n");
+		for (int t = 0; t < 6; t++)
+		{
+			for (int i = 0; i < POSITIONS; i++)
+				printf("%s%d", i == 0 ? "" : ",", trans[t][i]);
+			printf("\n");
+		}
+	}
+	else if (strcmp(argv[1], "to_text") == 0)
+	{
+		// Converts the binary solutions of ExactCover -binary_sols to
+		// the text format of ExactCover
+		if (argc > 2) { print_usage(argv[0]); return 1; }
+		ECSolutionReader reader(stdin);
+		const char *error = reader.open();
+		if (error != 0)
+		{
+			fprintf(stderr, "error: %s\n", error);
+			return 1;
+		}
+		std::vector<uint32_t> rows;
+		while (reader.next(rows))
+		{
+			for (size_t i = 0; i < rows.size(); i++)
+				if (*reader.name(rows[i]) != '\0')
+					printf("%s|", reader.name(rows[i]));
+			printf("\n");
+		}
+		if (reader.error() != 0)
+		{
+			fprintf(stderr, "error: %s\n", reader.error());
+			return 1;
+		}
 	}
 	else if (strcmp(argv[1], "normalize") == 0)
 	{